@@ -0,0 +1,398 @@
+/*
+ * C-level benchmark harness for the libsql API used by the Ring bindings.
+ *
+ * Usage: ring_libsql_bench [rows] [file_db_path]
+ *
+ * Every benchmark runs against ":memory:" and a file database and prints one
+ * JSON object per line with rows/sec, p50/p99 latency and peak RSS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libsql.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define BENCH_DEFAULT_ROWS 5000
+#define BENCH_BATCH_SIZE 1000
+
+typedef struct BenchResult
+{
+	double *aSamples;
+	int nSamples;
+	int nCapacity;
+	double nStart;
+	double nTotal;
+	long long nRows;
+} BenchResult;
+
+static double bench_now(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER nFreq, nCounter;
+	QueryPerformanceFrequency(&nFreq);
+	QueryPerformanceCounter(&nCounter);
+	return (double)nCounter.QuadPart / (double)nFreq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+static long long bench_peak_rss_kb(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+	{
+		return (long long)(pmc.PeakWorkingSetSize / 1024);
+	}
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return -1;
+	}
+#ifdef __APPLE__
+	return (long long)usage.ru_maxrss / 1024;
+#else
+	return (long long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+static void bench_check(int rc, const char *err_msg, const char *context)
+{
+	if (rc != 0)
+	{
+		fprintf(stderr, "%s failed: %s\n", context, err_msg ? err_msg : "unknown error");
+		exit(1);
+	}
+}
+
+static void bench_begin(BenchResult *pResult, int nSamples)
+{
+	pResult->aSamples = (double *)malloc(sizeof(double) * (nSamples > 0 ? nSamples : 1));
+	pResult->nCapacity = nSamples;
+	pResult->nSamples = 0;
+	pResult->nRows = 0;
+	pResult->nStart = bench_now();
+}
+
+static void bench_sample(BenchResult *pResult, double nSeconds)
+{
+	if (pResult->nSamples < pResult->nCapacity)
+	{
+		pResult->aSamples[pResult->nSamples++] = nSeconds;
+	}
+}
+
+static int bench_compare(const void *pA, const void *pB)
+{
+	double nA = *(const double *)pA;
+	double nB = *(const double *)pB;
+	return (nA > nB) - (nA < nB);
+}
+
+static double bench_percentile(BenchResult *pResult, double nPercent)
+{
+	if (pResult->nSamples == 0)
+	{
+		return 0;
+	}
+	int nIndex = (int)(nPercent / 100.0 * (pResult->nSamples - 1) + 0.5);
+	return pResult->aSamples[nIndex];
+}
+
+static void bench_report(BenchResult *pResult, const char *cName, const char *cDB, const char *cParam)
+{
+	pResult->nTotal = bench_now() - pResult->nStart;
+	qsort(pResult->aSamples, pResult->nSamples, sizeof(double), bench_compare);
+	printf("{\"harness\":\"c\",\"bench\":\"%s\",\"db\":\"%s\",\"param\":\"%s\",\"rows\":%lld,\"seconds\":%.6f,"
+		   "\"rows_per_sec\":%.1f,\"p50_us\":%.2f,\"p99_us\":%.2f,\"peak_rss_kb\":%lld}\n",
+		   cName, cDB, cParam, pResult->nRows, pResult->nTotal,
+		   pResult->nTotal > 0 ? pResult->nRows / pResult->nTotal : 0, bench_percentile(pResult, 50) * 1e6,
+		   bench_percentile(pResult, 99) * 1e6, bench_peak_rss_kb());
+	fflush(stdout);
+	free(pResult->aSamples);
+	pResult->aSamples = NULL;
+}
+
+static void bench_exec(libsql_connection_t conn, const char *cSQL)
+{
+	const char *err_msg = NULL;
+	bench_check(libsql_execute(conn, cSQL, &err_msg), err_msg, cSQL);
+}
+
+static void bench_reset_table(libsql_connection_t conn)
+{
+	bench_exec(conn, "DROP TABLE IF EXISTS bench");
+	bench_exec(conn, "CREATE TABLE bench (id INTEGER PRIMARY KEY, name TEXT, score REAL, payload BLOB)");
+}
+
+/* Reads every column of every row, like fetchAll() does */
+static long long bench_drain(libsql_rows_t rows)
+{
+	const char *err_msg = NULL;
+	libsql_row_t row;
+	long long nRows = 0;
+	int nCols = libsql_column_count(rows);
+	while (1)
+	{
+		bench_check(libsql_next_row(rows, &row, &err_msg), err_msg, "libsql_next_row");
+		if (!row)
+		{
+			break;
+		}
+		for (int x = 0; x < nCols; x++)
+		{
+			int type;
+			bench_check(libsql_column_type(rows, row, x, &type, &err_msg), err_msg, "libsql_column_type");
+			if (type == LIBSQL_INT)
+			{
+				long long value;
+				libsql_get_int(row, x, &value, &err_msg);
+			}
+			else if (type == LIBSQL_FLOAT)
+			{
+				double value;
+				libsql_get_float(row, x, &value, &err_msg);
+			}
+			else if (type == LIBSQL_TEXT)
+			{
+				const char *value;
+				if (libsql_get_string(row, x, &value, &err_msg) == 0)
+				{
+					libsql_free_string(value);
+				}
+			}
+			else if (type == LIBSQL_BLOB)
+			{
+				blob b;
+				if (libsql_get_blob(row, x, &b, &err_msg) == 0)
+				{
+					libsql_free_blob(b);
+				}
+			}
+		}
+		libsql_free_row(row);
+		nRows++;
+	}
+	return nRows;
+}
+
+static void bench_insert_per_row(libsql_connection_t conn, const char *cDB, int nRows)
+{
+	BenchResult result;
+	char cSQL[256];
+	bench_reset_table(conn);
+	bench_begin(&result, nRows);
+	for (int x = 1; x <= nRows; x++)
+	{
+		snprintf(cSQL, sizeof(cSQL), "INSERT INTO bench (id, name, score) VALUES (%d, 'name%d', %d.5)", x, x, x);
+		double nStart = bench_now();
+		bench_exec(conn, cSQL);
+		bench_sample(&result, bench_now() - nStart);
+		result.nRows++;
+	}
+	bench_report(&result, "insert_per_row", cDB, "adhoc");
+}
+
+static void bench_insert_batched(libsql_connection_t conn, const char *cDB, int nRows)
+{
+	BenchResult result;
+	libsql_stmt_t stmt;
+	const char *err_msg = NULL;
+	char cName[32];
+	bench_reset_table(conn);
+	bench_check(libsql_prepare(conn, "INSERT INTO bench (id, name, score) VALUES (?, ?, ?)", &stmt, &err_msg), err_msg,
+				"libsql_prepare");
+	bench_begin(&result, nRows / BENCH_BATCH_SIZE + 1);
+	for (int x = 1; x <= nRows; x += BENCH_BATCH_SIZE)
+	{
+		double nStart = bench_now();
+		bench_exec(conn, "BEGIN");
+		for (int y = x; y < x + BENCH_BATCH_SIZE && y <= nRows; y++)
+		{
+			snprintf(cName, sizeof(cName), "name%d", y);
+			libsql_reset_stmt(stmt, &err_msg);
+			bench_check(libsql_bind_int(stmt, 1, y, &err_msg), err_msg, "libsql_bind_int");
+			bench_check(libsql_bind_string(stmt, 2, cName, &err_msg), err_msg, "libsql_bind_string");
+			bench_check(libsql_bind_float(stmt, 3, y + 0.5, &err_msg), err_msg, "libsql_bind_float");
+			bench_check(libsql_execute_stmt(stmt, &err_msg), err_msg, "libsql_execute_stmt");
+			result.nRows++;
+		}
+		bench_exec(conn, "COMMIT");
+		bench_sample(&result, bench_now() - nStart);
+	}
+	libsql_free_stmt(stmt);
+	bench_report(&result, "insert_batched", cDB, "prepared_tx1000");
+}
+
+static void bench_lookup_adhoc(libsql_connection_t conn, const char *cDB, int nRows)
+{
+	BenchResult result;
+	libsql_rows_t rows;
+	const char *err_msg = NULL;
+	char cSQL[128];
+	bench_begin(&result, nRows);
+	for (int x = 0; x < nRows; x++)
+	{
+		snprintf(cSQL, sizeof(cSQL), "SELECT id, name, score FROM bench WHERE id = %d", (x * 7919) % nRows + 1);
+		double nStart = bench_now();
+		bench_check(libsql_query(conn, cSQL, &rows, &err_msg), err_msg, "libsql_query");
+		result.nRows += bench_drain(rows);
+		libsql_free_rows(rows);
+		bench_sample(&result, bench_now() - nStart);
+	}
+	bench_report(&result, "point_lookup", cDB, "adhoc");
+}
+
+static void bench_lookup_prepared(libsql_connection_t conn, const char *cDB, int nRows)
+{
+	BenchResult result;
+	libsql_stmt_t stmt;
+	libsql_rows_t rows;
+	const char *err_msg = NULL;
+	bench_check(libsql_prepare(conn, "SELECT id, name, score FROM bench WHERE id = ?", &stmt, &err_msg), err_msg,
+				"libsql_prepare");
+	bench_begin(&result, nRows);
+	for (int x = 0; x < nRows; x++)
+	{
+		double nStart = bench_now();
+		libsql_reset_stmt(stmt, &err_msg);
+		bench_check(libsql_bind_int(stmt, 1, (x * 7919) % nRows + 1, &err_msg), err_msg, "libsql_bind_int");
+		bench_check(libsql_query_stmt(stmt, &rows, &err_msg), err_msg, "libsql_query_stmt");
+		result.nRows += bench_drain(rows);
+		libsql_free_rows(rows);
+		bench_sample(&result, bench_now() - nStart);
+	}
+	libsql_free_stmt(stmt);
+	bench_report(&result, "point_lookup", cDB, "prepared");
+}
+
+static void bench_full_scan(libsql_connection_t conn, const char *cDB)
+{
+	BenchResult result;
+	libsql_rows_t rows;
+	const char *err_msg = NULL;
+	bench_begin(&result, 10);
+	for (int x = 0; x < 10; x++)
+	{
+		double nStart = bench_now();
+		bench_check(libsql_query(conn, "SELECT id, name, score FROM bench", &rows, &err_msg), err_msg,
+					"libsql_query");
+		result.nRows += bench_drain(rows);
+		libsql_free_rows(rows);
+		bench_sample(&result, bench_now() - nStart);
+	}
+	bench_report(&result, "full_scan", cDB, "all_columns");
+}
+
+static void bench_blobs(libsql_connection_t conn, const char *cDB, int nBlobSize, int nCount)
+{
+	BenchResult result;
+	libsql_stmt_t stmt;
+	libsql_rows_t rows;
+	const char *err_msg = NULL;
+	char cParam[32];
+	unsigned char *pData = (unsigned char *)malloc(nBlobSize);
+	for (int x = 0; x < nBlobSize; x++)
+	{
+		pData[x] = (unsigned char)(x * 31);
+	}
+	snprintf(cParam, sizeof(cParam), "%d", nBlobSize);
+	bench_reset_table(conn);
+	bench_check(libsql_prepare(conn, "INSERT INTO bench (id, payload) VALUES (?, ?)", &stmt, &err_msg), err_msg,
+				"libsql_prepare");
+	bench_begin(&result, nCount);
+	bench_exec(conn, "BEGIN");
+	for (int x = 1; x <= nCount; x++)
+	{
+		double nStart = bench_now();
+		libsql_reset_stmt(stmt, &err_msg);
+		bench_check(libsql_bind_int(stmt, 1, x, &err_msg), err_msg, "libsql_bind_int");
+		bench_check(libsql_bind_blob(stmt, 2, pData, nBlobSize, &err_msg), err_msg, "libsql_bind_blob");
+		bench_check(libsql_execute_stmt(stmt, &err_msg), err_msg, "libsql_execute_stmt");
+		bench_sample(&result, bench_now() - nStart);
+		result.nRows++;
+	}
+	bench_exec(conn, "COMMIT");
+	libsql_free_stmt(stmt);
+	bench_report(&result, "blob_write", cDB, cParam);
+
+	bench_check(libsql_prepare(conn, "SELECT payload FROM bench WHERE id = ?", &stmt, &err_msg), err_msg,
+				"libsql_prepare");
+	bench_begin(&result, nCount);
+	for (int x = 1; x <= nCount; x++)
+	{
+		double nStart = bench_now();
+		libsql_reset_stmt(stmt, &err_msg);
+		bench_check(libsql_bind_int(stmt, 1, x, &err_msg), err_msg, "libsql_bind_int");
+		bench_check(libsql_query_stmt(stmt, &rows, &err_msg), err_msg, "libsql_query_stmt");
+		result.nRows += bench_drain(rows);
+		libsql_free_rows(rows);
+		bench_sample(&result, bench_now() - nStart);
+	}
+	libsql_free_stmt(stmt);
+	bench_report(&result, "blob_read", cDB, cParam);
+	free(pData);
+}
+
+static void bench_run(const char *cPath, const char *cDB, int nRows)
+{
+	static const int aBlobSizes[] = {64, 4096, 65536, 1048576};
+	libsql_database_t db;
+	libsql_connection_t conn;
+	const char *err_msg = NULL;
+	bench_check(libsql_open_ext(cPath, &db, &err_msg), err_msg, "libsql_open_ext");
+	bench_check(libsql_connect(db, &conn, &err_msg), err_msg, "libsql_connect");
+
+	bench_insert_per_row(conn, cDB, nRows);
+	bench_insert_batched(conn, cDB, nRows);
+	bench_lookup_adhoc(conn, cDB, nRows);
+	bench_lookup_prepared(conn, cDB, nRows);
+	bench_full_scan(conn, cDB);
+	for (size_t x = 0; x < sizeof(aBlobSizes) / sizeof(aBlobSizes[0]); x++)
+	{
+		/* Keep roughly 64 MB written per blob size */
+		int nCount = (int)(67108864 / aBlobSizes[x]);
+		if (nCount > nRows)
+		{
+			nCount = nRows;
+		}
+		bench_blobs(conn, cDB, aBlobSizes[x], nCount);
+	}
+
+	libsql_disconnect(conn);
+	libsql_close(db);
+}
+
+int main(int argc, char *argv[])
+{
+	int nRows = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_ROWS;
+	const char *cFile = argc > 2 ? argv[2] : "ring_libsql_bench.db";
+	if (nRows <= 0)
+	{
+		fprintf(stderr, "Usage: %s [rows] [file_db_path]\n", argv[0]);
+		return 1;
+	}
+
+	bench_run(":memory:", "memory", nRows);
+
+	remove(cFile);
+	bench_run(cFile, "file", nRows);
+	remove(cFile);
+	return 0;
+}
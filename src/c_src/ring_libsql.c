@@ -1,12 +1,41 @@
+/* 64-bit off_t for fseeko() / ftello() on 32-bit POSIX builds, set before any system header */
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include "libsql.h"
 #include "ring.h"
 
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/types.h>
+#include <time.h>
+#endif
+
+/* A WAL file can grow past 2 GB, where the long offsets of fseek() / ftell() overflow on Windows and 32-bit builds */
+#ifdef _WIN32
+#define RING_LIBSQL_FSEEK(pFile, nOffset, nWhence) _fseeki64((pFile), (__int64)(nOffset), (nWhence))
+#define RING_LIBSQL_FTELL(pFile) ((long long)_ftelli64(pFile))
+#else
+#define RING_LIBSQL_FSEEK(pFile, nOffset, nWhence) fseeko((pFile), (off_t)(nOffset), (nWhence))
+#define RING_LIBSQL_FTELL(pFile) ((long long)ftello(pFile))
+#endif
+
 #define RING_POINTER_LIBSQL_DB "LIBSQL_DATABASE"
 #define RING_POINTER_LIBSQL_CONN "LIBSQL_CONNECTION"
 #define RING_POINTER_LIBSQL_STMT "LIBSQL_STATEMENT"
 #define RING_POINTER_LIBSQL_ROWS "LIBSQL_ROWS"
 #define RING_POINTER_LIBSQL_ROW "LIBSQL_ROW"
 #define RING_POINTER_LIBSQL_ROWS_FUTURE "LIBSQL_ROWS_FUTURE"
+#define RING_POINTER_LIBSQL_BACKUP "LIBSQL_BACKUP"
+#define RING_POINTER_LIBSQL_SYNC "LIBSQL_SYNC"
 
 #define LIBSQL_CHECK_OK(result, err_msg)                                                                               \
 	if ((result) != 0)                                                                                                 \
@@ -15,8 +44,468 @@
 		return;                                                                                                        \
 	}
 
+#define RING_LIBSQL_ARENA_BLOCK_SIZE 4096
+#define RING_LIBSQL_ARENA_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+/* How integer columns reach Ring: doubles (default), decimal strings or packed little-endian 8-byte strings */
+#define RING_LIBSQL_INT64_NUMBER 0
+#define RING_LIBSQL_INT64_DECIMAL 1
+#define RING_LIBSQL_INT64_PACKED 2
+
+/* Types */
+
+/* Performance profile: PRAGMAs applied to every connection of a database, unset fields are left alone */
+typedef struct RingLibSQLProfile
+{
+	char cJournalMode[16];
+	char cSynchronous[16];
+	char cTempStore[16];
+	long long nCacheSize;
+	long long nMmapSize;
+	long long nBusyTimeout;
+	unsigned int nFlags;
+} RingLibSQLProfile;
+
+#define RING_LIBSQL_PROFILE_CACHE_SIZE 1
+#define RING_LIBSQL_PROFILE_MMAP_SIZE 2
+#define RING_LIBSQL_PROFILE_BUSY_TIMEOUT 4
+
+typedef struct RingLibSQLDB
+{
+	libsql_database_t db;
+	RingLibSQLProfile profile;
+	struct RingLibSQLMaint *pMaint;
+	struct RingLibSQLSync *pSync;
+} RingLibSQLDB;
+
+/* Bump allocator block, blocks are chained newest first */
+typedef struct RingLibSQLArenaBlock
+{
+	struct RingLibSQLArenaBlock *pNext;
+	size_t nSize;
+	size_t nUsed;
+	unsigned char aData[];
+} RingLibSQLArenaBlock;
+
+/* Per-connection scratch memory, valid until the next query or bulk call on the connection */
+typedef struct RingLibSQLArena
+{
+	RingLibSQLArenaBlock *pHead;
+	void *pLast;
+	size_t nCapacity;
+	size_t nUsed;
+	size_t nHighWater;
+	double nResets;
+} RingLibSQLArena;
+
+/* Retry policy for SQLITE_BUSY / SQLITE_LOCKED failures, disabled while nMaxRetries is 0 */
+typedef struct RingLibSQLBusyStrategy
+{
+	double nTimeout;
+	int nMaxRetries;
+	int nBaseDelay;
+	int nMaxDelay;
+	unsigned int nSeed;
+} RingLibSQLBusyStrategy;
+
+typedef struct RingLibSQLBusyMetrics
+{
+	double nStatements;
+	double nContended;
+	double nRetries;
+	double nWaitMs;
+	double nGiveUps;
+	double nLastRetries;
+	double nLastWaitMs;
+} RingLibSQLBusyMetrics;
+
+/* State of one call while it is being retried */
+typedef struct RingLibSQLBusyCall
+{
+	int nAttempt;
+	int lContended;
+	int lGaveUp;
+	double nStart;
+	double nWaitMs;
+} RingLibSQLBusyCall;
+
+/* Estimated bytes handed to Ring by the fetch and get paths, a limit of 0 is disabled */
+typedef struct RingLibSQLMemory
+{
+	double nSoftLimit;
+	double nHardLimit;
+	double nCurrent;
+	/* Bytes since the current chunk began, the part the soft limit applies to */
+	double nChunk;
+	double nPeak;
+	double nTotal;
+	double nChunks;
+	double nRejected;
+	char cError[128];
+} RingLibSQLMemory;
+
+/* Connection handle: reference counted because statements and rows keep using its arena */
+typedef struct RingLibSQLConn
+{
+	libsql_connection_t conn;
+	RingLibSQLArena arena;
+	RingLibSQLBusyStrategy busy;
+	RingLibSQLBusyMetrics busyMetrics;
+	RingLibSQLMemory memory;
+	struct RingLibSQLChangeFeed *pFeed;
+	struct RingLibSQLAdvisor *pAdvisor;
+	int lTransaction;
+	int nSavepoints;
+	int nRefs;
+} RingLibSQLConn;
+
+typedef struct RingLibSQLStmt
+{
+	libsql_stmt_t stmt;
+	RingLibSQLConn *pConn;
+	char *cSQL;
+	RingLibSQLBusyMetrics busyMetrics;
+} RingLibSQLStmt;
+
+/* Rows handle: the libsql result set plus one reusable cursor row slot */
+typedef struct RingLibSQLRows
+{
+	libsql_rows_t rows;
+	libsql_row_t row;
+	RingLibSQLConn *pConn;
+	int nInt64Mode;
+	int lMore;
+	int lStepped;
+	int lDone;
+	int lWrites;
+	char *cAdvisorSQL;
+	double nAdvisorMs;
+} RingLibSQLRows;
+
+/* Row handle from libsql_next_row(), keeps the int64 mode its rows handle had when it was fetched */
+typedef struct RingLibSQLRow
+{
+	libsql_row_t row;
+	int nInt64Mode;
+} RingLibSQLRow;
+
+#ifdef _WIN32
+typedef HANDLE RingLibSQLThread;
+typedef CRITICAL_SECTION RingLibSQLMutex;
+#define RING_LIBSQL_THREAD_FUNC(name) static DWORD WINAPI name(LPVOID pArg)
+#define RING_LIBSQL_THREAD_RETURN return 0
+#else
+typedef pthread_t RingLibSQLThread;
+typedef pthread_mutex_t RingLibSQLMutex;
+#define RING_LIBSQL_THREAD_FUNC(name) static void *name(void *pArg)
+#define RING_LIBSQL_THREAD_RETURN return NULL
+#endif
+
+#define RING_LIBSQL_BACKUP_RUNNING 0
+#define RING_LIBSQL_BACKUP_DONE 1
+#define RING_LIBSQL_BACKUP_FAILED 2
+#define RING_LIBSQL_BACKUP_CANCELLED 3
+
+/* One unit of backup work: run a statement, or copy a table by rowid ranges or by primary key ranges (WITHOUT ROWID) */
+/* Outside WAL mode a commit by another connection restarts the copy; past this many restarts the backup fails */
+#define RING_LIBSQL_BACKUP_MAX_RESTARTS 8
+
+#define RING_LIBSQL_BACKUP_EXEC 1
+#define RING_LIBSQL_BACKUP_COPY 2
+#define RING_LIBSQL_BACKUP_COPY_KEY 3
+
+/* cSQL is the statement of an EXEC task and the stored column list of a copy; cKey and cKeyQuote are the
+   primary key columns and the expression that renders a key as SQL literals */
+typedef struct RingLibSQLBackupTask
+{
+	int nKind;
+	char *cName;
+	char *cSQL;
+	char *cKey;
+	char *cKeyQuote;
+} RingLibSQLBackupTask;
+
+/* Snapshot of the backup state, shared with the background thread under the mutex */
+typedef struct RingLibSQLBackupProgress
+{
+	int nState;
+	double nTasksDone;
+	double nTasksTotal;
+	double nRowsCopied;
+	double nPagesCopied;
+	double nPagesTotal;
+	double nRestarts;
+	double nElapsedMs;
+	char cError[512];
+} RingLibSQLBackupProgress;
+
+/* Online backup: a private connection copying into an attached file. In WAL mode it holds one read snapshot for
+   the whole copy; otherwise every step is its own transaction and a commit by another connection restarts it */
+typedef struct RingLibSQLBackup
+{
+	libsql_connection_t conn;
+	char *cDest;
+	RingLibSQLBackupTask *aTasks;
+	int nTasks;
+	int nTask;
+	long long nLast;
+	int lHasLast;
+	char *cLastKey;
+	int lSnapshot;
+	long long nDataVersion;
+	double nStart;
+	RingLibSQLBackupProgress progress;
+	RingLibSQLMutex mutex;
+	RingLibSQLThread thread;
+	int lThread;
+	int nThreadRows;
+	int nThreadPause;
+	int lCancel;
+} RingLibSQLBackup;
+
+#define RING_LIBSQL_MAINT_TICK_MS 100
+#define RING_LIBSQL_MAINT_BUSY_TIMEOUT_MS 1000
+
+/* Maintenance policy; a zero threshold disables that trigger */
+typedef struct RingLibSQLMaintConfig
+{
+	char cCheckpointMode[16];
+	double nWalSize;
+	double nInterval;
+	int nVacuumPages;
+	double nVacuumIdle;
+} RingLibSQLMaintConfig;
+
+typedef struct RingLibSQLMaintStats
+{
+	double nTicks;
+	double nWalBytes;
+	double nWalPendingFrames;
+	double nCheckpoints;
+	double nCheckpointsBusy;
+	double nCheckpointFrames;
+	double nCheckpointLastMs;
+	double nCheckpointMaxMs;
+	double nCheckpointTotalMs;
+	double nVacuumRuns;
+	double nPagesFreed;
+	double nFreelistPages;
+	double nIdleMs;
+	char cError[512];
+} RingLibSQLMaintStats;
+
+/* WAL checkpoint / incremental vacuum worker owned by a database handle */
+typedef struct RingLibSQLMaint
+{
+	libsql_connection_t conn;
+	RingLibSQLMaintConfig config;
+	RingLibSQLMaintStats stats;
+	char *cWalPath;
+	RingLibSQLMutex mutex;
+	RingLibSQLThread thread;
+	int lStop;
+} RingLibSQLMaint;
+
+#define RING_LIBSQL_SYNC_RUNNING 0
+#define RING_LIBSQL_SYNC_DONE 1
+#define RING_LIBSQL_SYNC_FAILED 2
+#define RING_LIBSQL_SYNC_CANCELLED 3
+#define RING_LIBSQL_SYNC_DEADLINE 4
+
+/* Pause between passes that found no new frames while waiting for a target frame */
+#define RING_LIBSQL_SYNC_IDLE_MS 50
+
+/* Snapshot of the sync state, shared with the background thread under the mutex */
+typedef struct RingLibSQLSyncProgress
+{
+	int nState;
+	double nPasses;
+	double nFrameNo;
+	double nFramesSynced;
+	double nBytes;
+	double nElapsedMs;
+	double nLastPassMs;
+	char cError[512];
+} RingLibSQLSyncProgress;
+
+/* Replica catch-up running libsql_sync2() passes on a worker. Each pass syncs to the primary's head, so the target
+   frame and the pass deadline are only checked between passes and never bound a single pass */
+typedef struct RingLibSQLSync
+{
+	libsql_database_t db;
+	RingLibSQLDB *pDB;
+	double nTargetFrame;
+	double nDeadlineMs;
+	double nPageBytes;
+	double nStart;
+	RingLibSQLSyncProgress progress;
+	RingLibSQLMutex mutex;
+	RingLibSQLThread thread;
+	int lThread;
+	int lCancel;
+} RingLibSQLSync;
+
+/* Change operations, the same codes sqlite3_update_hook() reports */
+#define RING_LIBSQL_CHANGE_INSERT 18
+#define RING_LIBSQL_CHANGE_UPDATE 23
+#define RING_LIBSQL_CHANGE_DELETE 9
+
+#define RING_LIBSQL_CHANGES_MAX_TABLES 64
+#define RING_LIBSQL_CHANGES_MIN_CAPACITY 16
+
+/* Ring buffer index access shared by the change feed producer and consumer */
+#ifdef _WIN32
+#define RING_LIBSQL_LOAD_ACQUIRE(p) ((unsigned int)InterlockedCompareExchange((volatile LONG *)(p), 0, 0))
+#define RING_LIBSQL_STORE_RELEASE(p, v) InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#else
+#define RING_LIBSQL_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_LIBSQL_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+typedef struct RingLibSQLChange
+{
+	int nOp;
+	int nTable;
+	long long nRowID;
+} RingLibSQLChange;
+
+/* Change feed: temp triggers log writes to temp.ring_libsql_changes, and committed rows are moved into a
+   bounded single-producer/single-consumer ring (the connection's write calls produce, drain consumes) */
+typedef struct RingLibSQLChangeFeed
+{
+	RingLibSQLChange *aChanges;
+	unsigned int nMask;
+	volatile unsigned int nHead;
+	volatile unsigned int nTail;
+	char *aTables[RING_LIBSQL_CHANGES_MAX_TABLES];
+	char aWatched[RING_LIBSQL_CHANGES_MAX_TABLES];
+	int nTables;
+	int nWatched;
+	double nCaptured;
+	double nDrained;
+	double nOverflow;
+	double nHarvests;
+	double nHarvestErrors;
+	double nSavedChanges;
+	int lSavedChanges;
+	int lDirty;
+	int nInt64Mode;
+} RingLibSQLChangeFeed;
+
+/* Statements tracked per reported one, so a statement that gets expensive late can still reach the top */
+#define RING_LIBSQL_ADVISOR_SLOTS 4
+
+/* One EXPLAIN QUERY PLAN row */
+typedef struct RingLibSQLPlanStep
+{
+	int nID;
+	int nParent;
+	char *cDetail;
+} RingLibSQLPlanStep;
+
+typedef struct RingLibSQLAdvisorEntry
+{
+	char *cSQL;
+	unsigned int nHash;
+	double nCalls;
+	double nTotalMs;
+	double nMaxMs;
+	/* Insertion order, the oldest single-call entry makes room when no entry has repeated */
+	double nSeq;
+	/* Plan captured when the statement first entered the top N */
+	RingLibSQLPlanStep *aPlan;
+	int nPlan;
+	int lPlan;
+	char *cPlanError;
+} RingLibSQLAdvisorEntry;
+
+/* Index advisor: time spent per SQL text in the connection's execute and query calls */
+typedef struct RingLibSQLAdvisor
+{
+	RingLibSQLAdvisorEntry *aEntries;
+	int nEntries;
+	int nCapacity;
+	int nTop;
+	double nInserts;
+} RingLibSQLAdvisor;
+
+#define RING_LIBSQL_BUFFER_NOMEM 1
+#define RING_LIBSQL_BUFFER_LIMIT 2
+
+/* Growable output buffer that lives in a connection arena; nLimit caps nLen (0 = no cap) */
+typedef struct RingLibSQLBuffer
+{
+	RingLibSQLArena *pArena;
+	char *pData;
+	size_t nLen;
+	size_t nCap;
+	size_t nLimit;
+	int nFailed;
+} RingLibSQLBuffer;
+
 /* Helper Functions */
 
+/* Returns a malloc'd copy, or NULL when out of memory */
+static char *ring_libsql_strdup(const char *cStr)
+{
+	size_t nLen = strlen(cStr) + 1;
+	char *cCopy = (char *)malloc(nLen);
+	if (cCopy)
+	{
+		memcpy(cCopy, cStr, nLen);
+	}
+	return cCopy;
+}
+
+/* printf into a malloc'd string, or NULL when out of memory */
+static char *ring_libsql_sprintf(const char *cFormat, ...)
+{
+	va_list args;
+	va_start(args, cFormat);
+	int nLen = vsnprintf(NULL, 0, cFormat, args);
+	va_end(args);
+	if (nLen < 0)
+	{
+		return NULL;
+	}
+	char *cStr = (char *)malloc((size_t)nLen + 1);
+	if (cStr)
+	{
+		va_start(args, cFormat);
+		vsnprintf(cStr, (size_t)nLen + 1, cFormat, args);
+		va_end(args);
+	}
+	return cStr;
+}
+
+/* Wraps cStr in cQuote, doubling embedded quotes: "ident" or 'literal'; the result is malloc'd */
+static char *ring_libsql_quote(const char *cStr, char cQuote)
+{
+	size_t nLen = 2;
+	for (const char *p = cStr; *p; p++)
+	{
+		nLen += (*p == cQuote) ? 2 : 1;
+	}
+	char *cOut = (char *)malloc(nLen + 1);
+	if (!cOut)
+	{
+		return NULL;
+	}
+	char *q = cOut;
+	*q++ = cQuote;
+	for (const char *p = cStr; *p; p++)
+	{
+		if (*p == cQuote)
+		{
+			*q++ = cQuote;
+		}
+		*q++ = *p;
+	}
+	*q++ = cQuote;
+	*q = '\0';
+	return cOut;
+}
+
 static char *ring_string_lower(char *cStr)
 {
 	unsigned int x, nLen;
@@ -31,323 +520,5626 @@ static char *ring_string_lower(char *cStr)
 	return cStr;
 }
 
-/* Free Functions for Managed Pointers */
+/* Arena Allocator */
 
-void ring_libsql_free_db(void *pState, void *pPtr)
+static void ring_libsql_arena_free(RingLibSQLArena *pArena)
 {
-	if (pPtr)
+	RingLibSQLArenaBlock *pBlock = pArena->pHead;
+	while (pBlock)
 	{
-		libsql_close((libsql_database_t)pPtr);
+		RingLibSQLArenaBlock *pNext = pBlock->pNext;
+		free(pBlock);
+		pBlock = pNext;
 	}
+	pArena->pHead = NULL;
+	pArena->pLast = NULL;
+	pArena->nCapacity = 0;
+	pArena->nUsed = 0;
 }
 
-void ring_libsql_free_conn(void *pState, void *pPtr)
+static void *ring_libsql_arena_alloc(RingLibSQLArena *pArena, size_t nSize)
 {
-	if (pPtr)
+	RingLibSQLArenaBlock *pBlock = pArena->pHead;
+	nSize = RING_LIBSQL_ARENA_ALIGN(nSize);
+	if (!pBlock || pBlock->nSize - pBlock->nUsed < nSize)
+	{
+		size_t nBlockSize = pBlock ? pBlock->nSize * 2 : RING_LIBSQL_ARENA_BLOCK_SIZE;
+		if (nBlockSize < nSize)
+		{
+			nBlockSize = nSize;
+		}
+		pBlock = (RingLibSQLArenaBlock *)malloc(sizeof(RingLibSQLArenaBlock) + nBlockSize);
+		if (!pBlock)
+		{
+			return NULL;
+		}
+		pBlock->pNext = pArena->pHead;
+		pBlock->nSize = nBlockSize;
+		pBlock->nUsed = 0;
+		pArena->pHead = pBlock;
+		pArena->nCapacity += nBlockSize;
+	}
+	void *pMem = pBlock->aData + pBlock->nUsed;
+	pBlock->nUsed += nSize;
+	pArena->nUsed += nSize;
+	if (pArena->nUsed > pArena->nHighWater)
 	{
-		libsql_disconnect((libsql_connection_t)pPtr);
+		pArena->nHighWater = pArena->nUsed;
 	}
+	pArena->pLast = pMem;
+	return pMem;
 }
 
-void ring_libsql_free_stmt(void *pState, void *pPtr)
+/* Resizes an allocation, in place when it is the most recent one */
+static void *ring_libsql_arena_grow(RingLibSQLArena *pArena, void *pMem, size_t nOldSize, size_t nNewSize)
 {
-	if (pPtr)
+	RingLibSQLArenaBlock *pBlock = pArena->pHead;
+	if (pMem && pMem == pArena->pLast)
+	{
+		size_t nOld = RING_LIBSQL_ARENA_ALIGN(nOldSize);
+		size_t nNew = RING_LIBSQL_ARENA_ALIGN(nNewSize);
+		if (pBlock->nSize - (pBlock->nUsed - nOld) >= nNew)
+		{
+			pBlock->nUsed = pBlock->nUsed - nOld + nNew;
+			pArena->nUsed = pArena->nUsed - nOld + nNew;
+			if (pArena->nUsed > pArena->nHighWater)
+			{
+				pArena->nHighWater = pArena->nUsed;
+			}
+			return pMem;
+		}
+	}
+	void *pNew = ring_libsql_arena_alloc(pArena, nNewSize);
+	if (pNew && pMem)
 	{
-		libsql_free_stmt((libsql_stmt_t)pPtr);
+		memcpy(pNew, pMem, nOldSize);
 	}
+	return pNew;
 }
 
-void ring_libsql_free_rows(void *pState, void *pPtr)
+/* Releases everything handed out; multiple blocks are merged into one so steady state needs no malloc */
+static void ring_libsql_arena_reset(RingLibSQLArena *pArena)
 {
-	if (pPtr)
+	if (pArena->pHead && pArena->pHead->pNext)
 	{
-		libsql_free_rows((libsql_rows_t)pPtr);
+		size_t nCapacity = pArena->nCapacity;
+		ring_libsql_arena_free(pArena);
+		RingLibSQLArenaBlock *pBlock = (RingLibSQLArenaBlock *)malloc(sizeof(RingLibSQLArenaBlock) + nCapacity);
+		if (pBlock)
+		{
+			pBlock->pNext = NULL;
+			pBlock->nSize = nCapacity;
+			pBlock->nUsed = 0;
+			pArena->pHead = pBlock;
+			pArena->nCapacity = nCapacity;
+		}
+	}
+	else if (pArena->pHead)
+	{
+		pArena->pHead->nUsed = 0;
 	}
+	pArena->pLast = NULL;
+	pArena->nUsed = 0;
+	pArena->nResets++;
 }
 
-void ring_libsql_free_row(void *pState, void *pPtr)
+static int ring_libsql_buffer_append(RingLibSQLBuffer *pBuf, const char *pData, size_t nLen)
+{
+	if (pBuf->nFailed)
+	{
+		return 0;
+	}
+	if (pBuf->nLimit && pBuf->nLen + nLen > pBuf->nLimit)
+	{
+		pBuf->nFailed = RING_LIBSQL_BUFFER_LIMIT;
+		return 0;
+	}
+	if (pBuf->nLen + nLen > pBuf->nCap)
+	{
+		size_t nCap = pBuf->nCap ? pBuf->nCap * 2 : 1024;
+		while (nCap < pBuf->nLen + nLen)
+		{
+			nCap *= 2;
+		}
+		if (pBuf->nLimit && nCap > pBuf->nLimit)
+		{
+			nCap = pBuf->nLimit;
+		}
+		char *pNew = (char *)ring_libsql_arena_grow(pBuf->pArena, pBuf->pData, pBuf->nLen, nCap);
+		if (!pNew)
+		{
+			pBuf->nFailed = RING_LIBSQL_BUFFER_NOMEM;
+			return 0;
+		}
+		pBuf->pData = pNew;
+		pBuf->nCap = nCap;
+	}
+	memcpy(pBuf->pData + pBuf->nLen, pData, nLen);
+	pBuf->nLen += nLen;
+	return 1;
+}
+
+static int ring_libsql_buffer_appendstr(RingLibSQLBuffer *pBuf, const char *cStr)
+{
+	return ring_libsql_buffer_append(pBuf, cStr, strlen(cStr));
+}
+
+/* Connection Helpers */
+
+static RingLibSQLConn *ring_libsql_conn_retain(RingLibSQLConn *pConn)
 {
-	if (pPtr)
+	pConn->nRefs++;
+	return pConn;
+}
+
+static void ring_libsql_changes_free(RingLibSQLChangeFeed *pFeed);
+static void ring_libsql_advisor_free(RingLibSQLAdvisor *pAdvisor);
+
+static void ring_libsql_conn_release(RingLibSQLConn *pConn)
+{
+	if (--pConn->nRefs == 0)
 	{
-		libsql_free_row((libsql_row_t)pPtr);
+		ring_libsql_changes_free(pConn->pFeed);
+		ring_libsql_advisor_free(pConn->pAdvisor);
+		ring_libsql_arena_free(&pConn->arena);
+		free(pConn);
 	}
 }
 
-/* Functions */
+/* disconnect() closes the libsql connection while statements and rows may still hold the handle */
+static RingLibSQLConn *ring_libsql_get_conn(void *pPointer, int nPara)
+{
+	RingLibSQLConn *pConn = (RingLibSQLConn *)RING_API_GETCPOINTER(nPara, RING_POINTER_LIBSQL_CONN);
+	if (!pConn || !pConn->conn)
+	{
+		RING_API_ERROR("Connection is closed");
+		return NULL;
+	}
+	return pConn;
+}
 
-RING_FUNC(ring_libsql_enable_internal_tracing)
+/* Statements and rows outlive disconnect() through their reference, but can no longer run on it */
+static RingLibSQLStmt *ring_libsql_get_stmt(void *pPointer, int nPara)
 {
-	RING_API_RETNUMBER(libsql_enable_internal_tracing());
+	RingLibSQLStmt *pStmt = (RingLibSQLStmt *)RING_API_GETCPOINTER(nPara, RING_POINTER_LIBSQL_STMT);
+	if (!pStmt)
+	{
+		RING_API_ERROR(RING_API_NULLPOINTER);
+		return NULL;
+	}
+	if (!pStmt->pConn->conn)
+	{
+		RING_API_ERROR("Connection is closed");
+		return NULL;
+	}
+	return pStmt;
 }
 
-RING_FUNC(ring_libsql_sync)
+static RingLibSQLRows *ring_libsql_get_rows(void *pPointer, int nPara)
 {
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 1)
+	RingLibSQLRows *pRows = (RingLibSQLRows *)RING_API_GETCPOINTER(nPara, RING_POINTER_LIBSQL_ROWS);
+	if (!pRows)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
-		return;
+		RING_API_ERROR(RING_API_NULLPOINTER);
+		return NULL;
 	}
-	if (!RING_API_ISPOINTER(1))
+	if (!pRows->pConn->conn)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
-		return;
+		RING_API_ERROR("Connection is closed");
+		return NULL;
 	}
-	libsql_database_t db = (libsql_database_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_DB);
-	int rc = libsql_sync(db, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	return pRows;
 }
 
-RING_FUNC(ring_libsql_sync2)
+static RingLibSQLRow *ring_libsql_get_row(void *pPointer, int nPara)
 {
-	const char *err_msg;
-	replicated repl;
-	if (RING_API_PARACOUNT != 1)
+	RingLibSQLRow *pRow = (RingLibSQLRow *)RING_API_GETCPOINTER(nPara, RING_POINTER_LIBSQL_ROW);
+	if (!pRow)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
-		return;
+		RING_API_ERROR(RING_API_NULLPOINTER);
+		return NULL;
 	}
-	if (!RING_API_ISPOINTER(1))
+	return pRow;
+}
+
+/* Performance Profile */
+
+static int ring_libsql_equals_nocase(const char *cA, const char *cB)
+{
+	while (*cA && *cB)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
-		return;
+		if (tolower((unsigned char)*cA) != tolower((unsigned char)*cB))
+		{
+			return 0;
+		}
+		cA++;
+		cB++;
 	}
-	libsql_database_t db = (libsql_database_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_DB);
-	int rc = libsql_sync2(db, &repl, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	List *pList = RING_API_NEWLIST;
-	ring_list_adddouble(pList, repl.frame_no);
-	ring_list_adddouble(pList, repl.frames_synced);
-	RING_API_RETLIST(pList);
+	return *cA == *cB;
 }
 
-RING_FUNC(ring_libsql_open_sync)
+/* Compares the first nLen characters; a shorter cA never matches */
+static int ring_libsql_equals_nocase_n(const char *cA, const char *cB, size_t nLen)
 {
-	const char *err_msg;
-	libsql_database_t db;
-	if (RING_API_PARACOUNT != 5)
+	for (size_t x = 0; x < nLen; x++)
 	{
-		RING_API_ERROR("Expected 5 parameters: db_path, primary_url, "
-					   "auth_token, read_your_writes, encryption_key");
-		return;
+		if (!cA[x] || tolower((unsigned char)cA[x]) != tolower((unsigned char)cB[x]))
+		{
+			return 0;
+		}
 	}
-	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3) || !RING_API_ISNUMBER(4) ||
-		!RING_API_ISSTRING(5))
+	return 1;
+}
+
+/* Stores a PRAGMA keyword if it is one of aAllowed, or a number in 0..nMaxNumber (-1 disables numbers) */
+static int ring_libsql_profile_word(char *cDest, size_t nSize, List *pItem, const char **aAllowed, int nMaxNumber)
+{
+	if (ring_list_isnumber(pItem, 2))
+	{
+		int nValue = (int)ring_list_getdouble(pItem, 2);
+		if (nValue < 0 || nValue > nMaxNumber)
+		{
+			return -1;
+		}
+		snprintf(cDest, nSize, "%d", nValue);
+		return 1;
+	}
+	if (ring_list_isstring(pItem, 2))
+	{
+		for (int x = 0; aAllowed[x]; x++)
+		{
+			if (ring_libsql_equals_nocase(ring_list_getstring(pItem, 2), aAllowed[x]))
+			{
+				snprintf(cDest, nSize, "%s", aAllowed[x]);
+				return 1;
+			}
+		}
+	}
+	return -1;
+}
+
+/* Returns 1 when the key is a profile key and was stored, 0 when it is not a profile key, -1 on a bad value */
+static int ring_libsql_profile_parse(RingLibSQLProfile *pProfile, const char *cKey, List *pItem)
+{
+	static const char *aJournalModes[] = {"delete", "truncate", "persist", "memory", "wal", "off", NULL};
+	static const char *aSynchronous[] = {"off", "normal", "full", "extra", NULL};
+	static const char *aTempStore[] = {"default", "file", "memory", NULL};
+	long long nValue;
+	if (strcmp(cKey, "journal_mode") == 0)
+	{
+		return ring_libsql_profile_word(pProfile->cJournalMode, sizeof(pProfile->cJournalMode), pItem, aJournalModes,
+										-1);
+	}
+	if (strcmp(cKey, "synchronous") == 0)
+	{
+		return ring_libsql_profile_word(pProfile->cSynchronous, sizeof(pProfile->cSynchronous), pItem, aSynchronous, 3);
+	}
+	if (strcmp(cKey, "temp_store") == 0)
+	{
+		return ring_libsql_profile_word(pProfile->cTempStore, sizeof(pProfile->cTempStore), pItem, aTempStore, 2);
+	}
+	if (strcmp(cKey, "cache_size") != 0 && strcmp(cKey, "mmap_size") != 0 && strcmp(cKey, "busy_timeout") != 0)
+	{
+		return 0;
+	}
+	if (!ring_list_isnumber(pItem, 2))
+	{
+		return -1;
+	}
+	nValue = (long long)ring_list_getdouble(pItem, 2);
+	if (strcmp(cKey, "cache_size") == 0)
+	{
+		pProfile->nCacheSize = nValue;
+		pProfile->nFlags |= RING_LIBSQL_PROFILE_CACHE_SIZE;
+	}
+	else if (strcmp(cKey, "mmap_size") == 0)
+	{
+		pProfile->nMmapSize = nValue;
+		pProfile->nFlags |= RING_LIBSQL_PROFILE_MMAP_SIZE;
+	}
+	else
+	{
+		pProfile->nBusyTimeout = nValue;
+		pProfile->nFlags |= RING_LIBSQL_PROFILE_BUSY_TIMEOUT;
+	}
+	return 1;
+}
+
+/* Fills the fields that were not given explicitly from a named preset */
+static int ring_libsql_profile_preset(RingLibSQLProfile *pProfile, const char *cPreset)
+{
+	int lFast = ring_libsql_equals_nocase(cPreset, "fast");
+	if (!lFast && !ring_libsql_equals_nocase(cPreset, "safe"))
+	{
+		return 0;
+	}
+	if (!pProfile->cJournalMode[0])
+	{
+		strcpy(pProfile->cJournalMode, "wal");
+	}
+	if (!pProfile->cSynchronous[0])
+	{
+		strcpy(pProfile->cSynchronous, lFast ? "normal" : "full");
+	}
+	if (!pProfile->cTempStore[0] && lFast)
+	{
+		strcpy(pProfile->cTempStore, "memory");
+	}
+	if (!(pProfile->nFlags & RING_LIBSQL_PROFILE_CACHE_SIZE) && lFast)
+	{
+		/* Negative values are KiB: 64 MB page cache */
+		pProfile->nCacheSize = -65536;
+		pProfile->nFlags |= RING_LIBSQL_PROFILE_CACHE_SIZE;
+	}
+	if (!(pProfile->nFlags & RING_LIBSQL_PROFILE_MMAP_SIZE) && lFast)
+	{
+		pProfile->nMmapSize = 268435456;
+		pProfile->nFlags |= RING_LIBSQL_PROFILE_MMAP_SIZE;
+	}
+	if (!(pProfile->nFlags & RING_LIBSQL_PROFILE_BUSY_TIMEOUT))
+	{
+		pProfile->nBusyTimeout = 5000;
+		pProfile->nFlags |= RING_LIBSQL_PROFILE_BUSY_TIMEOUT;
+	}
+	return 1;
+}
+
+/* PRAGMA statements may return a row, so they go through libsql_query and are stepped once */
+static int ring_libsql_pragma(libsql_connection_t conn, const char *cSQL, const char **err_msg)
+{
+	libsql_rows_t rows;
+	libsql_row_t row = NULL;
+	int rc = libsql_query(conn, cSQL, &rows, err_msg);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	rc = libsql_next_row(rows, &row, err_msg);
+	if (row)
+	{
+		libsql_free_row(row);
+	}
+	libsql_free_rows(rows);
+	return rc;
+}
+
+static int ring_libsql_profile_apply(RingLibSQLProfile *pProfile, libsql_connection_t conn, const char **err_msg)
+{
+	char cSQL[64];
+	int rc = 0;
+	/* busy_timeout goes first so the journal_mode switch can wait for other connections */
+	if (pProfile->nFlags & RING_LIBSQL_PROFILE_BUSY_TIMEOUT)
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA busy_timeout = %lld", pProfile->nBusyTimeout);
+		rc = ring_libsql_pragma(conn, cSQL, err_msg);
+	}
+	if (rc == 0 && pProfile->cJournalMode[0])
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA journal_mode = %s", pProfile->cJournalMode);
+		rc = ring_libsql_pragma(conn, cSQL, err_msg);
+	}
+	if (rc == 0 && pProfile->cSynchronous[0])
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA synchronous = %s", pProfile->cSynchronous);
+		rc = ring_libsql_pragma(conn, cSQL, err_msg);
+	}
+	if (rc == 0 && (pProfile->nFlags & RING_LIBSQL_PROFILE_CACHE_SIZE))
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA cache_size = %lld", pProfile->nCacheSize);
+		rc = ring_libsql_pragma(conn, cSQL, err_msg);
+	}
+	if (rc == 0 && (pProfile->nFlags & RING_LIBSQL_PROFILE_MMAP_SIZE))
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA mmap_size = %lld", pProfile->nMmapSize);
+		rc = ring_libsql_pragma(conn, cSQL, err_msg);
+	}
+	if (rc == 0 && pProfile->cTempStore[0])
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA temp_store = %s", pProfile->cTempStore);
+		rc = ring_libsql_pragma(conn, cSQL, err_msg);
+	}
+	return rc;
+}
+
+/* Parses the profile keys of a config list; returns 0 and sets err_msg on an invalid value */
+static int ring_libsql_profile_from_list(RingLibSQLProfile *pProfile, List *pList, const char **err_msg)
+{
+	const char *cPreset = NULL;
+	memset(pProfile, 0, sizeof(RingLibSQLProfile));
+	for (int i = 1; i <= ring_list_getsize(pList); i++)
+	{
+		if (!ring_list_islist(pList, i))
+			continue;
+		List *pItem = ring_list_getlist(pList, i);
+		if (ring_list_getsize(pItem) != 2 || !ring_list_isstring(pItem, 1))
+			continue;
+		char *key = ring_string_lower(ring_list_getstring(pItem, 1));
+		if (strcmp(key, "profile") == 0 && ring_list_isstring(pItem, 2))
+		{
+			cPreset = ring_list_getstring(pItem, 2);
+		}
+		else if (ring_libsql_profile_parse(pProfile, key, pItem) < 0)
+		{
+			*err_msg = "Invalid value for a performance profile key";
+			return 0;
+		}
+	}
+	if (cPreset && !ring_libsql_profile_preset(pProfile, cPreset))
+	{
+		*err_msg = "Unknown performance profile: expected \"fast\" or \"safe\"";
+		return 0;
+	}
+	return 1;
+}
+
+/* Platform Helpers */
+
+static double ring_libsql_now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER nFreq, nCounter;
+	QueryPerformanceFrequency(&nFreq);
+	QueryPerformanceCounter(&nCounter);
+	return (double)nCounter.QuadPart * 1000.0 / (double)nFreq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+#endif
+}
+
+static void ring_libsql_sleep_ms(int nMs)
+{
+#ifdef _WIN32
+	Sleep((DWORD)nMs);
+#else
+	struct timespec ts;
+	ts.tv_sec = nMs / 1000;
+	ts.tv_nsec = (long)(nMs % 1000) * 1000000L;
+	nanosleep(&ts, NULL);
+#endif
+}
+
+static int ring_libsql_thread_start(RingLibSQLThread *pThread,
+#ifdef _WIN32
+									DWORD(WINAPI *pFunc)(LPVOID),
+#else
+									void *(*pFunc)(void *),
+#endif
+									void *pArg)
+{
+#ifdef _WIN32
+	*pThread = CreateThread(NULL, 0, pFunc, pArg, 0, NULL);
+	return *pThread != NULL;
+#else
+	return pthread_create(pThread, NULL, pFunc, pArg) == 0;
+#endif
+}
+
+static void ring_libsql_thread_join(RingLibSQLThread thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+}
+
+static void ring_libsql_mutex_init(RingLibSQLMutex *pMutex)
+{
+#ifdef _WIN32
+	InitializeCriticalSection(pMutex);
+#else
+	pthread_mutex_init(pMutex, NULL);
+#endif
+}
+
+static void ring_libsql_mutex_destroy(RingLibSQLMutex *pMutex)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(pMutex);
+#else
+	pthread_mutex_destroy(pMutex);
+#endif
+}
+
+static void ring_libsql_mutex_lock(RingLibSQLMutex *pMutex)
+{
+#ifdef _WIN32
+	EnterCriticalSection(pMutex);
+#else
+	pthread_mutex_lock(pMutex);
+#endif
+}
+
+static void ring_libsql_mutex_unlock(RingLibSQLMutex *pMutex)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(pMutex);
+#else
+	pthread_mutex_unlock(pMutex);
+#endif
+}
+
+/* Transaction State */
+
+/* Length of the SQL keyword at cSQL if it equals cWord (case-insensitive), else 0 */
+static size_t ring_libsql_sql_keyword(const char *cSQL, const char *cWord)
+{
+	size_t nLen = strlen(cWord);
+	if (!ring_libsql_equals_nocase_n(cSQL, cWord, nLen) || isalnum((unsigned char)cSQL[nLen]) || cSQL[nLen] == '_')
+	{
+		return 0;
+	}
+	return nLen;
+}
+
+/* Skips the whitespace, semicolons and comments in front of a statement */
+static const char *ring_libsql_sql_skip(const char *cSQL)
+{
+	for (;;)
+	{
+		if (isspace((unsigned char)*cSQL) || *cSQL == ';')
+		{
+			cSQL++;
+		}
+		else if (cSQL[0] == '-' && cSQL[1] == '-')
+		{
+			while (*cSQL && *cSQL != '\n')
+			{
+				cSQL++;
+			}
+		}
+		else if (cSQL[0] == '/' && cSQL[1] == '*')
+		{
+			const char *cEnd = strstr(cSQL + 2, "*/");
+			cSQL = cEnd ? cEnd + 2 : cSQL + strlen(cSQL);
+		}
+		else
+		{
+			return cSQL;
+		}
+	}
+}
+
+/* The C API has no sqlite3_get_autocommit(), so a connection follows the transaction statements that succeed on
+   it: BEGIN, COMMIT / END, ROLLBACK (but not ROLLBACK TO), SAVEPOINT and RELEASE. A transaction that SQLite rolls
+   back by itself after an I/O or full-disk error is only noticed at the next one of these statements */
+static void ring_libsql_txn_track(RingLibSQLConn *pConn, const char *cSQL)
+{
+	size_t nLen;
+	if (!cSQL)
+	{
+		return;
+	}
+	cSQL = ring_libsql_sql_skip(cSQL);
+	if (ring_libsql_sql_keyword(cSQL, "BEGIN"))
+	{
+		pConn->lTransaction = 1;
+	}
+	else if (ring_libsql_sql_keyword(cSQL, "COMMIT") || ring_libsql_sql_keyword(cSQL, "END"))
+	{
+		pConn->lTransaction = 0;
+		pConn->nSavepoints = 0;
+	}
+	else if ((nLen = ring_libsql_sql_keyword(cSQL, "ROLLBACK")) != 0)
+	{
+		cSQL += nLen;
+		while (isspace((unsigned char)*cSQL))
+		{
+			cSQL++;
+		}
+		if ((nLen = ring_libsql_sql_keyword(cSQL, "TRANSACTION")) != 0)
+		{
+			cSQL += nLen;
+			while (isspace((unsigned char)*cSQL))
+			{
+				cSQL++;
+			}
+		}
+		if (!ring_libsql_sql_keyword(cSQL, "TO"))
+		{
+			pConn->lTransaction = 0;
+			pConn->nSavepoints = 0;
+		}
+	}
+	else if (ring_libsql_sql_keyword(cSQL, "SAVEPOINT"))
+	{
+		pConn->nSavepoints++;
+	}
+	else if (ring_libsql_sql_keyword(cSQL, "RELEASE") && pConn->nSavepoints > 0)
+	{
+		pConn->nSavepoints--;
+	}
+}
+
+static int ring_libsql_in_transaction(RingLibSQLConn *pConn)
+{
+	return pConn->lTransaction || pConn->nSavepoints > 0;
+}
+
+/* Statements that can change rows; WITH is counted because it may lead into an INSERT, UPDATE or DELETE */
+static int ring_libsql_sql_writes(const char *cSQL)
+{
+	static const char *aWords[] = {"INSERT", "UPDATE", "DELETE", "REPLACE", "WITH"};
+	if (!cSQL)
+	{
+		return 0;
+	}
+	cSQL = ring_libsql_sql_skip(cSQL);
+	for (size_t x = 0; x < sizeof(aWords) / sizeof(aWords[0]); x++)
+	{
+		if (ring_libsql_sql_keyword(cSQL, aWords[x]))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Busy Handling */
+
+/* The experimental C API returns only an error string, never the SQLite result code. libsql formats a failure
+   as "<context>: <sqlite message>", sometimes with the message in backticks, so contention is recognised only
+   when the last segment is exactly SQLite's text for SQLITE_BUSY / SQLITE_LOCKED, or the message starts with
+   the code name. A RAISE() or constraint message that merely mentions a locked database is not retried */
+static int ring_libsql_is_busy(const char *err_msg)
+{
+	static const char *aMessages[] = {"database is locked", "database table is locked"};
+	if (!err_msg)
+	{
+		return 0;
+	}
+	if (strncmp(err_msg, "SQLITE_BUSY", 11) == 0 || strncmp(err_msg, "SQLITE_LOCKED", 13) == 0)
+	{
+		return 1;
+	}
+	const char *cSegment = err_msg;
+	for (const char *p = strstr(err_msg, ": "); p; p = strstr(p + 2, ": "))
+	{
+		cSegment = p + 2;
+	}
+	if (*cSegment == '`')
+	{
+		cSegment++;
+	}
+	size_t nLen = strlen(cSegment);
+	while (nLen > 0 && (cSegment[nLen - 1] == '`' || isspace((unsigned char)cSegment[nLen - 1])))
+	{
+		nLen--;
+	}
+	for (size_t x = 0; x < sizeof(aMessages) / sizeof(aMessages[0]); x++)
+	{
+		if (nLen == strlen(aMessages[x]) && strncmp(cSegment, aMessages[x], nLen) == 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void ring_libsql_busy_begin(RingLibSQLBusyCall *pCall)
+{
+	pCall->nAttempt = 0;
+	pCall->lContended = 0;
+	pCall->lGaveUp = 0;
+	pCall->nStart = 0;
+	pCall->nWaitMs = 0;
+}
+
+/* Sleeps with exponential backoff and full jitter; returns 1 when the failed call should be retried. Inside a
+   transaction the connection keeps its locks between attempts, so a lock upgrade could never succeed: the error
+   goes straight back to the caller, who has to roll back and retry the whole transaction */
+static int ring_libsql_busy_retry(RingLibSQLConn *pConn, RingLibSQLBusyCall *pCall, int rc, const char *err_msg)
+{
+	RingLibSQLBusyStrategy *pBusy = &pConn->busy;
+	if (rc == 0 || pBusy->nMaxRetries <= 0 || ring_libsql_in_transaction(pConn) || !ring_libsql_is_busy(err_msg))
+	{
+		return 0;
+	}
+	double nNow = ring_libsql_now_ms();
+	if (pCall->nAttempt == 0)
+	{
+		pCall->nStart = nNow;
+		pCall->lContended = 1;
+	}
+	if (pCall->nAttempt >= pBusy->nMaxRetries || (pBusy->nTimeout > 0 && nNow - pCall->nStart >= pBusy->nTimeout))
+	{
+		pCall->lGaveUp = 1;
+		return 0;
+	}
+	double nCeiling = (double)pBusy->nBaseDelay * (double)(1u << (pCall->nAttempt < 16 ? pCall->nAttempt : 16));
+	if (nCeiling > pBusy->nMaxDelay)
+	{
+		nCeiling = pBusy->nMaxDelay;
+	}
+	/* xorshift32 keeps the jitter independent of the C library rand() state */
+	pBusy->nSeed ^= pBusy->nSeed << 13;
+	pBusy->nSeed ^= pBusy->nSeed >> 17;
+	pBusy->nSeed ^= pBusy->nSeed << 5;
+	int nDelay = (int)(nCeiling * (double)(pBusy->nSeed % 10001) / 10000.0);
+	if (pBusy->nTimeout > 0 && nNow - pCall->nStart + nDelay > pBusy->nTimeout)
+	{
+		nDelay = (int)(pBusy->nTimeout - (nNow - pCall->nStart));
+	}
+	if (nDelay > 0)
+	{
+		ring_libsql_sleep_ms(nDelay);
+	}
+	pCall->nAttempt++;
+	pCall->nWaitMs = ring_libsql_now_ms() - pCall->nStart;
+	return 1;
+}
+
+static void ring_libsql_busy_record(RingLibSQLBusyMetrics *pMetrics, RingLibSQLBusyCall *pCall, int nStatements)
+{
+	pMetrics->nStatements += nStatements;
+	pMetrics->nContended += pCall->lContended;
+	pMetrics->nRetries += pCall->nAttempt;
+	pMetrics->nWaitMs += pCall->nWaitMs;
+	pMetrics->nGiveUps += pCall->lGaveUp;
+	pMetrics->nLastRetries = pCall->nAttempt;
+	pMetrics->nLastWaitMs = pCall->nWaitMs;
+}
+
+/* All busy accounting happens here, once per call; calls made while the strategy is off are not counted */
+static void ring_libsql_busy_end(RingLibSQLConn *pConn, RingLibSQLBusyCall *pCall, RingLibSQLBusyMetrics *pStmtMetrics)
+{
+	if (pConn->busy.nMaxRetries <= 0)
+	{
+		return;
+	}
+	ring_libsql_busy_record(&pConn->busyMetrics, pCall, 1);
+	if (pStmtMetrics)
+	{
+		ring_libsql_busy_record(pStmtMetrics, pCall, 1);
+	}
+}
+
+static void ring_libsql_list_addpair(List *pList, const char *cName, double nValue)
+{
+	List *pItem = ring_list_newlist(pList);
+	ring_list_addstring(pItem, cName);
+	ring_list_adddouble(pItem, nValue);
+}
+
+static void ring_libsql_busy_addmetrics(List *pList, RingLibSQLBusyMetrics *pMetrics)
+{
+	ring_libsql_list_addpair(pList, "busy_statements", pMetrics->nStatements);
+	ring_libsql_list_addpair(pList, "busy_contended", pMetrics->nContended);
+	ring_libsql_list_addpair(pList, "busy_retries", pMetrics->nRetries);
+	ring_libsql_list_addpair(pList, "busy_wait_ms", pMetrics->nWaitMs);
+	ring_libsql_list_addpair(pList, "busy_give_ups", pMetrics->nGiveUps);
+	ring_libsql_list_addpair(pList, "busy_last_retries", pMetrics->nLastRetries);
+	ring_libsql_list_addpair(pList, "busy_last_wait_ms", pMetrics->nLastWaitMs);
+}
+
+/* Online Backup */
+
+/* Runs a query that returns one integer; *pNull is set when it returns no row or NULL */
+static int ring_libsql_query_int(libsql_connection_t conn, const char *cSQL, long long *pValue, int *pNull,
+								 const char **err_msg)
+{
+	libsql_rows_t rows;
+	libsql_row_t row = NULL;
+	int type = LIBSQL_NULL;
+	*pValue = 0;
+	*pNull = 1;
+	int rc = libsql_query(conn, cSQL, &rows, err_msg);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	rc = libsql_next_row(rows, &row, err_msg);
+	if (rc == 0 && row)
+	{
+		rc = libsql_column_type(rows, row, 0, &type, err_msg);
+		if (rc == 0 && type != LIBSQL_NULL)
+		{
+			rc = libsql_get_int(row, 0, pValue, err_msg);
+			*pNull = rc != 0;
+		}
+	}
+	if (row)
+	{
+		libsql_free_row(row);
+	}
+	libsql_free_rows(rows);
+	return rc;
+}
+
+/* Runs a query built by ring_libsql_sprintf that returns one string and frees it; *pValue is a malloc'd copy,
+   NULL when the query returns no row or NULL */
+static int ring_libsql_query_text(libsql_connection_t conn, char *cSQL, char **pValue, const char **err_msg)
+{
+	libsql_rows_t rows;
+	libsql_row_t row = NULL;
+	const char *cValue;
+	int type = LIBSQL_NULL;
+	*pValue = NULL;
+	if (!cSQL)
+	{
+		*err_msg = "Out of memory";
+		return 1;
+	}
+	int rc = libsql_query(conn, cSQL, &rows, err_msg);
+	free(cSQL);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	rc = libsql_next_row(rows, &row, err_msg);
+	if (rc == 0 && row)
+	{
+		rc = libsql_column_type(rows, row, 0, &type, err_msg);
+		if (rc == 0 && type != LIBSQL_NULL && (rc = libsql_get_string(row, 0, &cValue, err_msg)) == 0)
+		{
+			*pValue = ring_libsql_strdup(cValue);
+			libsql_free_string(cValue);
+			if (!*pValue)
+			{
+				*err_msg = "Out of memory";
+				rc = 1;
+			}
+		}
+	}
+	if (row)
+	{
+		libsql_free_row(row);
+	}
+	libsql_free_rows(rows);
+	return rc;
+}
+
+/* Runs a statement built by ring_libsql_sprintf and frees it */
+static int ring_libsql_backup_exec(RingLibSQLBackup *pBackup, char *cSQL, const char **err_msg)
+{
+	if (!cSQL)
+	{
+		*err_msg = "Out of memory";
+		return 1;
+	}
+	int rc = libsql_execute(pBackup->conn, cSQL, err_msg);
+	free(cSQL);
+	return rc;
+}
+
+static int ring_libsql_backup_addtask(RingLibSQLBackup *pBackup, int nKind, const char *cName, char *cSQL)
+{
+	char *cQuoted = cName ? ring_libsql_quote(cName, '"') : NULL;
+	RingLibSQLBackupTask *aTasks = NULL;
+	if ((cName && !cQuoted) || (!cName && !cSQL) ||
+		!(aTasks = (RingLibSQLBackupTask *)realloc(pBackup->aTasks,
+												   sizeof(RingLibSQLBackupTask) * (pBackup->nTasks + 1))))
+	{
+		free(cQuoted);
+		free(cSQL);
+		return 0;
+	}
+	pBackup->aTasks = aTasks;
+	aTasks[pBackup->nTasks].nKind = nKind;
+	aTasks[pBackup->nTasks].cName = cQuoted;
+	aTasks[pBackup->nTasks].cSQL = cSQL;
+	aTasks[pBackup->nTasks].cKey = NULL;
+	aTasks[pBackup->nTasks].cKeyQuote = NULL;
+	pBackup->nTasks++;
+	return 1;
+}
+
+static void ring_libsql_backup_freetasks(RingLibSQLBackup *pBackup)
+{
+	for (int x = 0; x < pBackup->nTasks; x++)
+	{
+		free(pBackup->aTasks[x].cName);
+		free(pBackup->aTasks[x].cSQL);
+		free(pBackup->aTasks[x].cKey);
+		free(pBackup->aTasks[x].cKeyQuote);
+	}
+	free(pBackup->aTasks);
+	pBackup->aTasks = NULL;
+	pBackup->nTasks = 0;
+	free(pBackup->cLastKey);
+	pBackup->cLastKey = NULL;
+}
+
+/* Queues the copy of one table. Generated columns cannot be inserted, so the copy names the stored columns;
+   WITHOUT ROWID tables (found through pragma_table_list) are paged by primary key ranges */
+static int ring_libsql_backup_addcopy(RingLibSQLBackup *pBackup, const char *cName, const char **err_msg)
+{
+	char *cColumns = NULL, *cKey = NULL, *cKeyQuote = NULL;
+	long long nWithoutRowid = 0;
+	int lNull;
+	char *cLiteral = ring_libsql_quote(cName, '\'');
+	if (!cLiteral)
+	{
+		*err_msg = "Out of memory";
+		return 1;
+	}
+	char *cSQL = ring_libsql_sprintf("SELECT wr FROM pragma_table_list WHERE schema = 'main' AND name = %s", cLiteral);
+	int rc = cSQL ? ring_libsql_query_int(pBackup->conn, cSQL, &nWithoutRowid, &lNull, err_msg) : 1;
+	free(cSQL);
+	if (rc == 0)
+	{
+		rc = ring_libsql_query_text(
+			pBackup->conn,
+			ring_libsql_sprintf("SELECT group_concat('\"' || replace(name, '\"', '\"\"') || '\"', ',') FROM "
+								"(SELECT name FROM pragma_table_xinfo(%s, 'main') WHERE hidden = 0 ORDER BY cid)",
+								cLiteral),
+			&cColumns, err_msg);
+	}
+	if (rc == 0 && nWithoutRowid)
+	{
+		const char *cKeyColumns = "(SELECT name FROM pragma_table_info(%s, 'main') WHERE pk > 0 ORDER BY pk)";
+		char *cFrom = ring_libsql_sprintf(cKeyColumns, cLiteral);
+		rc = ring_libsql_query_text(
+			pBackup->conn,
+			cFrom ? ring_libsql_sprintf("SELECT group_concat('\"' || replace(name, '\"', '\"\"') || '\"', ',') FROM %s",
+										cFrom)
+				  : NULL,
+			&cKey, err_msg);
+		if (rc == 0)
+		{
+			rc = ring_libsql_query_text(
+				pBackup->conn,
+				cFrom ? ring_libsql_sprintf("SELECT group_concat('quote(\"' || replace(name, '\"', '\"\"') || '\")', "
+											"' || '','' || ') FROM %s",
+											cFrom)
+					  : NULL,
+				&cKeyQuote, err_msg);
+		}
+		free(cFrom);
+	}
+	free(cLiteral);
+	if (rc == 0 && (!cColumns || (nWithoutRowid && (!cKey || !cKeyQuote))))
+	{
+		*err_msg = "Could not read the columns of a table to back up";
+		rc = 1;
+	}
+	if (rc == 0 &&
+		!ring_libsql_backup_addtask(pBackup, nWithoutRowid ? RING_LIBSQL_BACKUP_COPY_KEY : RING_LIBSQL_BACKUP_COPY,
+									cName, cColumns))
+	{
+		cColumns = NULL;
+		*err_msg = "Out of memory while planning the backup";
+		rc = 1;
+	}
+	if (rc != 0)
+	{
+		free(cColumns);
+		free(cKey);
+		free(cKeyQuote);
+		return rc;
+	}
+	pBackup->aTasks[pBackup->nTasks - 1].cKey = cKey;
+	pBackup->aTasks[pBackup->nTasks - 1].cKeyQuote = cKeyQuote;
+	return 0;
+}
+
+/* sqlite_schema keeps normalized SQL ("CREATE TABLE name..."), so the target schema goes after the keywords */
+static char *ring_libsql_backup_qualify(const char *cSQL)
+{
+	static const char *aPrefixes[] = {"CREATE TABLE ",		  "CREATE VIRTUAL TABLE ", "CREATE UNIQUE INDEX ",
+									  "CREATE INDEX ",		  "CREATE VIEW ",		   "CREATE TRIGGER ",
+									  NULL};
+	for (int x = 0; aPrefixes[x]; x++)
+	{
+		size_t nLen = strlen(aPrefixes[x]);
+		if (strncmp(cSQL, aPrefixes[x], nLen) == 0)
+		{
+			/* Shadow tables of virtual tables already exist when their turn comes */
+			const char *cExtra = (x == 0) ? "IF NOT EXISTS " : "";
+			return ring_libsql_sprintf("%.*s%sring_backup.%s", (int)nLen, cSQL, cExtra, cSQL + nLen);
+		}
+	}
+	return NULL;
+}
+
+/* Queues the work for one kind of schema entry, reading the schema seen by the snapshot */
+static int ring_libsql_backup_plan_pass(RingLibSQLBackup *pBackup, int nPass, const char **err_msg)
+{
+	libsql_rows_t rows;
+	libsql_row_t row = NULL;
+	int rc = libsql_query(pBackup->conn,
+						  "SELECT type, name, sql FROM main.sqlite_master WHERE sql IS NOT NULL "
+						  "AND (name NOT LIKE 'sqlite\\_%' ESCAPE '\\' OR name = 'sqlite_sequence') "
+						  "AND name NOT LIKE 'libsql\\_%' ESCAPE '\\' "
+						  "AND name NOT IN (SELECT name || '_shadow' FROM main.sqlite_master WHERE type = 'index') "
+						  "ORDER BY rowid",
+						  &rows, err_msg);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	while ((rc = libsql_next_row(rows, &row, err_msg)) == 0 && row)
+	{
+		const char *aColumns[3] = {NULL, NULL, NULL};
+		for (int x = 0; x < 3 && rc == 0; x++)
+		{
+			rc = libsql_get_string(row, x, &aColumns[x], err_msg);
+		}
+		if (rc == 0)
+		{
+			const char *cName = aColumns[1], *cSQL = aColumns[2];
+			int lTable = strcmp(aColumns[0], "table") == 0;
+			int lSequence = strcmp(cName, "sqlite_sequence") == 0;
+			int lOk = 1;
+			if ((nPass == 0 && lTable && !lSequence) || (nPass == 3 && !lTable))
+			{
+				char *cQualified = ring_libsql_backup_qualify(cSQL);
+				lOk = cQualified && ring_libsql_backup_addtask(pBackup, RING_LIBSQL_BACKUP_EXEC, NULL, cQualified);
+			}
+			else if (nPass == 1 && lTable && !lSequence && strncmp(cSQL, "CREATE VIRTUAL TABLE ", 21) != 0)
+			{
+				rc = ring_libsql_backup_addcopy(pBackup, cName, err_msg);
+			}
+			else if (nPass == 2 && lSequence)
+			{
+				/* Copying AUTOINCREMENT tables fills sqlite_sequence, the source counters replace it afterwards */
+				lOk = ring_libsql_backup_addtask(pBackup, RING_LIBSQL_BACKUP_EXEC, NULL,
+												 ring_libsql_strdup("DELETE FROM ring_backup.sqlite_sequence")) &&
+					  ring_libsql_backup_addtask(
+						  pBackup, RING_LIBSQL_BACKUP_EXEC, NULL,
+						  ring_libsql_strdup("INSERT INTO ring_backup.sqlite_sequence SELECT * FROM main.sqlite_sequence"));
+			}
+			if (!lOk)
+			{
+				*err_msg = "Out of memory while planning the backup";
+				rc = 1;
+			}
+		}
+		for (int x = 0; x < 3; x++)
+		{
+			if (aColumns[x])
+			{
+				libsql_free_string(aColumns[x]);
+			}
+		}
+		libsql_free_row(row);
+		row = NULL;
+		if (rc != 0)
+		{
+			break;
+		}
+	}
+	libsql_free_rows(rows);
+	return rc;
+}
+
+static int ring_libsql_backup_fail(RingLibSQLBackup *pBackup, const char *cError)
+{
+	ring_libsql_mutex_lock(&pBackup->mutex);
+	pBackup->progress.nState = RING_LIBSQL_BACKUP_FAILED;
+	snprintf(pBackup->progress.cError, sizeof(pBackup->progress.cError), "%s", cError ? cError : "Backup failed");
+	ring_libsql_mutex_unlock(&pBackup->mutex);
+	return -1;
+}
+
+/* Attaches the destination, opens the read snapshot and plans the copy; returns 0 or an error code */
+static int ring_libsql_backup_open(RingLibSQLBackup *pBackup, const char **err_msg)
+{
+	long long nValue = 0;
+	int lNull;
+	char *cPath = ring_libsql_quote(pBackup->cDest, '\'');
+	int rc = ring_libsql_backup_exec(pBackup, cPath ? ring_libsql_sprintf("ATTACH DATABASE %s AS ring_backup", cPath) : NULL,
+									 err_msg);
+	free(cPath);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	/* The copy goes to a fresh file that is deleted on failure, so it needs no journal */
+	const char *aSetup[] = {"PRAGMA main.page_size", "PRAGMA ring_backup.page_size = %lld", "PRAGMA main.auto_vacuum",
+							"PRAGMA ring_backup.auto_vacuum = %lld", NULL};
+	for (int x = 0; aSetup[x]; x += 2)
+	{
+		rc = ring_libsql_query_int(pBackup->conn, aSetup[x], &nValue, &lNull, err_msg);
+		if (rc == 0 && !lNull)
+		{
+			char *cSQL = ring_libsql_sprintf(aSetup[x + 1], nValue);
+			rc = cSQL ? ring_libsql_pragma(pBackup->conn, cSQL, err_msg) : 1;
+			free(cSQL);
+		}
+		if (rc != 0)
+		{
+			return rc;
+		}
+	}
+	rc = ring_libsql_pragma(pBackup->conn, "PRAGMA ring_backup.journal_mode = OFF", err_msg);
+	if (rc == 0)
+	{
+		char *cMode = NULL;
+		rc = ring_libsql_query_text(pBackup->conn, ring_libsql_strdup("PRAGMA main.journal_mode"), &cMode, err_msg);
+		pBackup->lSnapshot = cMode && ring_libsql_equals_nocase(cMode, "wal");
+		free(cMode);
+	}
+	/* Outside WAL mode a long read transaction would block every writer, so only the planning runs in it and
+	   data_version tells the steps whether another connection has committed since */
+	if (rc == 0)
+	{
+		rc = libsql_execute(pBackup->conn, "BEGIN", err_msg);
+	}
+	if (rc == 0)
+	{
+		rc = ring_libsql_query_int(pBackup->conn, "PRAGMA main.data_version", &pBackup->nDataVersion, &lNull,
+								   err_msg);
+	}
+	if (rc == 0)
+	{
+		rc = ring_libsql_query_int(pBackup->conn, "PRAGMA main.page_count", &nValue, &lNull, err_msg);
+	}
+	for (int nPass = 0; nPass < 4 && rc == 0; nPass++)
+	{
+		rc = ring_libsql_backup_plan_pass(pBackup, nPass, err_msg);
+	}
+	if (rc == 0 && !pBackup->lSnapshot)
+	{
+		rc = libsql_execute(pBackup->conn, "COMMIT", err_msg);
+	}
+	ring_libsql_mutex_lock(&pBackup->mutex);
+	pBackup->progress.nPagesTotal = (double)nValue;
+	pBackup->progress.nTasksTotal = pBackup->nTasks;
+	ring_libsql_mutex_unlock(&pBackup->mutex);
+	return rc;
+}
+
+/* Another connection committed between two steps: the partial copy is dropped and the backup starts over */
+static int ring_libsql_backup_restart(RingLibSQLBackup *pBackup, const char **err_msg)
+{
+	int rc = libsql_execute(pBackup->conn, "COMMIT", err_msg);
+	if (rc == 0)
+	{
+		rc = libsql_execute(pBackup->conn, "DETACH DATABASE ring_backup", err_msg);
+	}
+	if (rc != 0)
+	{
+		return rc;
+	}
+	remove(pBackup->cDest);
+	ring_libsql_backup_freetasks(pBackup);
+	pBackup->nTask = 0;
+	pBackup->nLast = 0;
+	pBackup->lHasLast = 0;
+	ring_libsql_mutex_lock(&pBackup->mutex);
+	pBackup->progress.nRestarts++;
+	pBackup->progress.nTasksDone = 0;
+	pBackup->progress.nRowsCopied = 0;
+	pBackup->progress.nPagesCopied = 0;
+	ring_libsql_mutex_unlock(&pBackup->mutex);
+	return ring_libsql_backup_open(pBackup, err_msg);
+}
+
+/* Copies the next slice of a WITHOUT ROWID table: the key of the nRows-th row bounds the slice, like the rowid copy */
+static int ring_libsql_backup_copykey(RingLibSQLBackup *pBackup, RingLibSQLBackupTask *pTask, int nRows,
+									  long long *pCopied, int *pTaskDone, const char **err_msg)
+{
+	char *cUpper = NULL;
+	char *cLower = pBackup->cLastKey ? ring_libsql_sprintf("(%s) > (%s)", pTask->cKey, pBackup->cLastKey)
+									 : ring_libsql_strdup("1");
+	if (!cLower)
+	{
+		*err_msg = "Out of memory";
+		return 1;
+	}
+	int rc = ring_libsql_query_text(pBackup->conn,
+									ring_libsql_sprintf("SELECT %s FROM main.%s WHERE %s ORDER BY %s LIMIT 1 OFFSET %d",
+														pTask->cKeyQuote, pTask->cName, cLower, pTask->cKey, nRows - 1),
+									&cUpper, err_msg);
+	if (rc == 0)
+	{
+		char *cRange = cUpper ? ring_libsql_sprintf("AND (%s) <= (%s)", pTask->cKey, cUpper) : ring_libsql_strdup("");
+		rc = ring_libsql_backup_exec(pBackup,
+									 cRange ? ring_libsql_sprintf("INSERT OR REPLACE INTO ring_backup.%s (%s) SELECT %s "
+																  "FROM main.%s WHERE %s %s ORDER BY %s",
+																  pTask->cName, pTask->cSQL, pTask->cSQL, pTask->cName,
+																  cLower, cRange, pTask->cKey)
+										    : NULL,
+									 err_msg);
+		free(cRange);
+	}
+	free(cLower);
+	if (rc != 0)
+	{
+		free(cUpper);
+		return rc;
+	}
+	*pCopied = (long long)libsql_changes(pBackup->conn);
+	*pTaskDone = cUpper == NULL;
+	free(pBackup->cLastKey);
+	pBackup->cLastKey = cUpper;
+	return 0;
+}
+
+/* Runs one step copying at most nRows rows; returns 1 while work remains, 0 when complete, -1 on failure */
+static int ring_libsql_backup_copy(RingLibSQLBackup *pBackup, int nRows)
+{
+	const char *err_msg = NULL;
+	long long nCopied = 0;
+	long long nPages;
+	long long nVersion;
+	int lNull;
+	int rc = 0;
+	int lTaskDone = 1;
+	if (pBackup->progress.nState != RING_LIBSQL_BACKUP_RUNNING)
+	{
+		return pBackup->progress.nState == RING_LIBSQL_BACKUP_DONE ? 0 : -1;
+	}
+	if (!pBackup->lSnapshot)
+	{
+		/* data_version is read first, so the shared lock it takes covers the whole step */
+		rc = libsql_execute(pBackup->conn, "BEGIN", &err_msg);
+		if (rc == 0)
+		{
+			rc = ring_libsql_query_int(pBackup->conn, "PRAGMA main.data_version", &nVersion, &lNull, &err_msg);
+		}
+		if (rc == 0 && nVersion != pBackup->nDataVersion &&
+			pBackup->progress.nRestarts >= RING_LIBSQL_BACKUP_MAX_RESTARTS)
+		{
+			libsql_execute(pBackup->conn, "ROLLBACK", &err_msg);
+			return ring_libsql_backup_fail(pBackup, "Backup restarted too many times because other connections kept "
+													"writing; switch the database to WAL mode to back it up under "
+													"write load");
+		}
+		if (rc == 0 && nVersion != pBackup->nDataVersion)
+		{
+			rc = ring_libsql_backup_restart(pBackup, &err_msg);
+			return rc == 0 ? 1 : ring_libsql_backup_fail(pBackup, err_msg);
+		}
+		/* A writer holds the lock: nothing was copied yet, so the step is simply tried again later */
+		if (rc != 0 && ring_libsql_is_busy(err_msg))
+		{
+			libsql_execute(pBackup->conn, "ROLLBACK", &err_msg);
+			return 1;
+		}
+		if (rc != 0)
+		{
+			return ring_libsql_backup_fail(pBackup, err_msg);
+		}
+	}
+	if (pBackup->nTask < pBackup->nTasks)
+	{
+		RingLibSQLBackupTask *pTask = &pBackup->aTasks[pBackup->nTask];
+		if (pTask->nKind == RING_LIBSQL_BACKUP_EXEC)
+		{
+			rc = libsql_execute(pBackup->conn, pTask->cSQL, &err_msg);
+		}
+		/* Copies use OR REPLACE because virtual tables seed their shadow tables when they are created */
+		else if (pTask->nKind == RING_LIBSQL_BACKUP_COPY_KEY)
+		{
+			rc = ring_libsql_backup_copykey(pBackup, pTask, nRows, &nCopied, &lTaskDone, &err_msg);
+		}
+		else
+		{
+			/* Keyset pagination: find the rowid that ends this slice, then copy up to it */
+			char cLower[64] = "";
+			long long nUpper;
+			if (pBackup->lHasLast)
+			{
+				snprintf(cLower, sizeof(cLower), "WHERE rowid > %lld", pBackup->nLast);
+			}
+			char *cSQL = ring_libsql_sprintf(
+				"SELECT max(rowid) FROM (SELECT rowid FROM main.%s %s ORDER BY rowid LIMIT %d)", pTask->cName, cLower,
+				nRows);
+			rc = cSQL ? ring_libsql_query_int(pBackup->conn, cSQL, &nUpper, &lNull, &err_msg) : 1;
+			free(cSQL);
+			if (rc == 0 && !lNull)
+			{
+				rc = ring_libsql_backup_exec(pBackup,
+											 ring_libsql_sprintf("INSERT OR REPLACE INTO ring_backup.%s (%s) SELECT %s "
+																 "FROM main.%s %s%s rowid <= %lld ORDER BY rowid",
+																 pTask->cName, pTask->cSQL, pTask->cSQL, pTask->cName,
+																 cLower, pBackup->lHasLast ? " AND" : "WHERE", nUpper),
+											 &err_msg);
+				nCopied = rc == 0 ? (long long)libsql_changes(pBackup->conn) : 0;
+				pBackup->nLast = nUpper;
+				pBackup->lHasLast = 1;
+				lTaskDone = 0;
+			}
+		}
+		if (rc != 0)
+		{
+			return ring_libsql_backup_fail(pBackup, err_msg ? err_msg : "Out of memory");
+		}
+		if (lTaskDone)
+		{
+			pBackup->nTask++;
+			pBackup->nLast = 0;
+			pBackup->lHasLast = 0;
+			free(pBackup->cLastKey);
+			pBackup->cLastKey = NULL;
+		}
+	}
+	rc = ring_libsql_query_int(pBackup->conn, "PRAGMA ring_backup.page_count", &nPages, &lNull, &err_msg);
+	int lDone = pBackup->nTask >= pBackup->nTasks;
+	if (rc == 0 && (lDone || !pBackup->lSnapshot))
+	{
+		rc = libsql_execute(pBackup->conn, "COMMIT", &err_msg);
+	}
+	if (rc == 0 && lDone)
+	{
+		rc = libsql_execute(pBackup->conn, "DETACH DATABASE ring_backup", &err_msg);
+	}
+	if (rc != 0)
+	{
+		return ring_libsql_backup_fail(pBackup, err_msg);
+	}
+	ring_libsql_mutex_lock(&pBackup->mutex);
+	pBackup->progress.nTasksDone = pBackup->nTask;
+	pBackup->progress.nRowsCopied += (double)nCopied;
+	pBackup->progress.nPagesCopied = (double)nPages;
+	pBackup->progress.nElapsedMs = ring_libsql_now_ms() - pBackup->nStart;
+	if (lDone)
+	{
+		pBackup->progress.nState = RING_LIBSQL_BACKUP_DONE;
+	}
+	ring_libsql_mutex_unlock(&pBackup->mutex);
+	return !lDone;
+}
+
+RING_LIBSQL_THREAD_FUNC(ring_libsql_backup_thread)
+{
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)pArg;
+	while (1)
+	{
+		ring_libsql_mutex_lock(&pBackup->mutex);
+		int lCancel = pBackup->lCancel;
+		ring_libsql_mutex_unlock(&pBackup->mutex);
+		if (lCancel || ring_libsql_backup_copy(pBackup, pBackup->nThreadRows) != 1)
+		{
+			break;
+		}
+		if (pBackup->nThreadPause > 0)
+		{
+			ring_libsql_sleep_ms(pBackup->nThreadPause);
+		}
+	}
+	RING_LIBSQL_THREAD_RETURN;
+}
+
+/* Stops the worker and releases the connection; an unfinished copy is rolled back and its file removed */
+static void ring_libsql_backup_close(RingLibSQLBackup *pBackup)
+{
+	const char *err_msg;
+	if (pBackup->lThread)
+	{
+		ring_libsql_mutex_lock(&pBackup->mutex);
+		pBackup->lCancel = 1;
+		ring_libsql_mutex_unlock(&pBackup->mutex);
+		ring_libsql_thread_join(pBackup->thread);
+		pBackup->lThread = 0;
+	}
+	if (pBackup->conn)
+	{
+		if (pBackup->progress.nState != RING_LIBSQL_BACKUP_DONE)
+		{
+			libsql_execute(pBackup->conn, "ROLLBACK", &err_msg);
+			libsql_execute(pBackup->conn, "DETACH DATABASE ring_backup", &err_msg);
+			remove(pBackup->cDest);
+			if (pBackup->progress.nState == RING_LIBSQL_BACKUP_RUNNING)
+			{
+				pBackup->progress.nState = RING_LIBSQL_BACKUP_CANCELLED;
+			}
+		}
+		libsql_disconnect(pBackup->conn);
+		pBackup->conn = NULL;
+	}
+	ring_libsql_backup_freetasks(pBackup);
+}
+
+/* Maintenance Scheduler */
+
+/* Reads the maintenance keys of a config list; returns 0 and sets err_msg on an invalid value */
+static int ring_libsql_maint_from_list(RingLibSQLMaintConfig *pConfig, List *pList, const char **err_msg)
+{
+	static const char *aModes[] = {"PASSIVE", "FULL", "RESTART", "TRUNCATE", NULL};
+	memset(pConfig, 0, sizeof(RingLibSQLMaintConfig));
+	strcpy(pConfig->cCheckpointMode, "PASSIVE");
+	pConfig->nVacuumIdle = 1000;
+	for (int i = 1; i <= ring_list_getsize(pList); i++)
+	{
+		if (!ring_list_islist(pList, i))
+			continue;
+		List *pItem = ring_list_getlist(pList, i);
+		if (ring_list_getsize(pItem) != 2 || !ring_list_isstring(pItem, 1))
+			continue;
+		char *key = ring_string_lower(ring_list_getstring(pItem, 1));
+		if (strcmp(key, "checkpoint_mode") == 0)
+		{
+			if (ring_libsql_profile_word(pConfig->cCheckpointMode, sizeof(pConfig->cCheckpointMode), pItem, aModes,
+										 -1) < 0)
+			{
+				*err_msg = "checkpoint_mode must be \"passive\", \"full\", \"restart\" or \"truncate\"";
+				return 0;
+			}
+			continue;
+		}
+		double *pValue = NULL;
+		if (strcmp(key, "checkpoint_wal_size") == 0)
+			pValue = &pConfig->nWalSize;
+		else if (strcmp(key, "checkpoint_interval") == 0)
+			pValue = &pConfig->nInterval;
+		else if (strcmp(key, "vacuum_idle") == 0)
+			pValue = &pConfig->nVacuumIdle;
+		else if (strcmp(key, "vacuum_pages") != 0)
+			continue;
+		if (!ring_list_isnumber(pItem, 2) || ring_list_getdouble(pItem, 2) < 0)
+		{
+			*err_msg = "Maintenance thresholds must be non-negative numbers";
+			return 0;
+		}
+		if (pValue)
+			*pValue = ring_list_getdouble(pItem, 2);
+		else
+			pConfig->nVacuumPages = (int)ring_list_getdouble(pItem, 2);
+	}
+	return 1;
+}
+
+static unsigned int ring_libsql_maint_be32(const unsigned char *p)
+{
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+/*
+ * The WAL is read from the file system so measuring it never touches the database. The file keeps its size after a
+ * checkpoint and is overwritten from the start once a writer resets it, so its size says nothing about the backlog.
+ * Instead count the frames stamped with the salt in the WAL header: they form a prefix of the file, stale frames from
+ * earlier generations carry an older salt, so a binary search over the frame headers finds the end of the log.
+ */
+static double ring_libsql_maint_walsize(RingLibSQLMaint *pMaint, long long *pFrames, unsigned int *pSalt,
+										long long *pFrameBytes)
+{
+	unsigned char aHeader[32], aFrame[24];
+	*pFrames = 0;
+	*pSalt = 0;
+	*pFrameBytes = 0;
+	FILE *pFile = pMaint->cWalPath ? fopen(pMaint->cWalPath, "rb") : NULL;
+	if (!pFile)
+	{
+		return 0;
+	}
+	long long nSize = RING_LIBSQL_FSEEK(pFile, 0, SEEK_END) == 0 ? RING_LIBSQL_FTELL(pFile) : -1;
+	if (nSize < 0 || RING_LIBSQL_FSEEK(pFile, 0, SEEK_SET) != 0)
+	{
+		fclose(pFile);
+		return 0;
+	}
+	if (fread(aHeader, 1, sizeof(aHeader), pFile) == sizeof(aHeader) &&
+		(ring_libsql_maint_be32(aHeader) & 0xFFFFFFFE) == 0x377F0682)
+	{
+		long long nPage = ring_libsql_maint_be32(aHeader + 8);
+		if (nPage == 1)
+		{
+			nPage = 65536;
+		}
+		long long nFrameBytes = nPage + (long long)sizeof(aFrame);
+		long long nLow = 0, nHigh = (nSize - (long long)sizeof(aHeader)) / nFrameBytes;
+		while (nLow < nHigh)
+		{
+			long long nMid = nLow + (nHigh - nLow + 1) / 2;
+			if (RING_LIBSQL_FSEEK(pFile, (long long)sizeof(aHeader) + (nMid - 1) * nFrameBytes, SEEK_SET) == 0 &&
+				fread(aFrame, 1, sizeof(aFrame), pFile) == sizeof(aFrame) && memcmp(aFrame + 8, aHeader + 16, 8) == 0)
+			{
+				nLow = nMid;
+			}
+			else
+			{
+				nHigh = nMid - 1;
+			}
+		}
+		*pFrames = nLow;
+		*pSalt = ring_libsql_maint_be32(aHeader + 16);
+		*pFrameBytes = nFrameBytes;
+	}
+	fclose(pFile);
+	return (double)nSize;
+}
+
+static void ring_libsql_maint_error(RingLibSQLMaint *pMaint, const char *err_msg)
+{
+	ring_libsql_mutex_lock(&pMaint->mutex);
+	snprintf(pMaint->stats.cError, sizeof(pMaint->stats.cError), "%s", err_msg ? err_msg : "Maintenance failed");
+	ring_libsql_mutex_unlock(&pMaint->mutex);
+}
+
+/* Returns the number of frames the checkpoint copied back into the database, or -1 on failure */
+static long long ring_libsql_maint_checkpoint(RingLibSQLMaint *pMaint)
+{
+	libsql_rows_t rows;
+	libsql_row_t row = NULL;
+	const char *err_msg;
+	long long aResult[3] = {0, 0, 0};
+	char cSQL[64];
+	snprintf(cSQL, sizeof(cSQL), "PRAGMA main.wal_checkpoint(%s)", pMaint->config.cCheckpointMode);
+	double nStart = ring_libsql_now_ms();
+	int rc = libsql_query(pMaint->conn, cSQL, &rows, &err_msg);
+	if (rc == 0)
+	{
+		/* One row: busy flag, frames in the WAL, frames checkpointed */
+		rc = libsql_next_row(rows, &row, &err_msg);
+		for (int x = 0; x < 3 && rc == 0 && row; x++)
+		{
+			rc = libsql_get_int(row, x, &aResult[x], &err_msg);
+		}
+		if (row)
+		{
+			libsql_free_row(row);
+		}
+		libsql_free_rows(rows);
+	}
+	if (rc != 0)
+	{
+		ring_libsql_maint_error(pMaint, err_msg);
+		return -1;
+	}
+	double nElapsed = ring_libsql_now_ms() - nStart;
+	ring_libsql_mutex_lock(&pMaint->mutex);
+	pMaint->stats.nCheckpoints++;
+	pMaint->stats.nCheckpointsBusy += aResult[0] != 0;
+	pMaint->stats.nCheckpointFrames = aResult[2] > 0 ? (double)aResult[2] : 0;
+	pMaint->stats.nCheckpointLastMs = nElapsed;
+	pMaint->stats.nCheckpointTotalMs += nElapsed;
+	if (nElapsed > pMaint->stats.nCheckpointMaxMs)
+	{
+		pMaint->stats.nCheckpointMaxMs = nElapsed;
+	}
+	ring_libsql_mutex_unlock(&pMaint->mutex);
+	return aResult[2] > 0 ? aResult[2] : 0;
+}
+
+/* Frees at most nVacuumPages pages; a no-op unless the database uses auto_vacuum = INCREMENTAL */
+static void ring_libsql_maint_vacuum(RingLibSQLMaint *pMaint)
+{
+	const char *err_msg;
+	long long nBefore, nAfter;
+	int lNull;
+	char cSQL[64];
+	int rc = ring_libsql_query_int(pMaint->conn, "PRAGMA main.freelist_count", &nBefore, &lNull, &err_msg);
+	if (rc == 0 && nBefore > 0)
+	{
+		snprintf(cSQL, sizeof(cSQL), "PRAGMA main.incremental_vacuum(%d)", pMaint->config.nVacuumPages);
+		/* The pragma frees one page per result row, so it only runs to completion when stepped to the end */
+		libsql_rows_t rows;
+		libsql_row_t row = NULL;
+		rc = libsql_query(pMaint->conn, cSQL, &rows, &err_msg);
+		if (rc == 0)
+		{
+			while ((rc = libsql_next_row(rows, &row, &err_msg)) == 0 && row)
+			{
+				libsql_free_row(row);
+				row = NULL;
+			}
+			libsql_free_rows(rows);
+		}
+		if (rc == 0)
+		{
+			rc = ring_libsql_query_int(pMaint->conn, "PRAGMA main.freelist_count", &nAfter, &lNull, &err_msg);
+		}
+	}
+	else
+	{
+		nAfter = nBefore;
+	}
+	if (rc != 0)
+	{
+		ring_libsql_maint_error(pMaint, err_msg);
+		return;
+	}
+	ring_libsql_mutex_lock(&pMaint->mutex);
+	if (nAfter < nBefore)
+	{
+		pMaint->stats.nVacuumRuns++;
+		pMaint->stats.nPagesFreed += (double)(nBefore - nAfter);
+	}
+	pMaint->stats.nFreelistPages = (double)nAfter;
+	ring_libsql_mutex_unlock(&pMaint->mutex);
+}
+
+RING_LIBSQL_THREAD_FUNC(ring_libsql_maint_thread)
+{
+	RingLibSQLMaint *pMaint = (RingLibSQLMaint *)pArg;
+	const char *err_msg;
+	long long nVersion, nLastVersion = -1;
+	int lNull;
+	double nNow = ring_libsql_now_ms();
+	double nLastCheckpoint = nNow;
+	double nLastActivity = nNow;
+	unsigned int nCheckpointSalt = 0;
+	long long nCheckpointFrames = 0, nBackfilled = 0;
+	while (1)
+	{
+		ring_libsql_sleep_ms(RING_LIBSQL_MAINT_TICK_MS);
+		ring_libsql_mutex_lock(&pMaint->mutex);
+		int lStop = pMaint->lStop;
+		ring_libsql_mutex_unlock(&pMaint->mutex);
+		if (lStop)
+		{
+			break;
+		}
+		nNow = ring_libsql_now_ms();
+		/* data_version changes whenever another connection commits, so an unchanged value means idle */
+		if (ring_libsql_query_int(pMaint->conn, "PRAGMA main.data_version", &nVersion, &lNull, &err_msg) != 0)
+		{
+			ring_libsql_maint_error(pMaint, err_msg);
+		}
+		else if (nVersion != nLastVersion)
+		{
+			nLastVersion = nVersion;
+			nLastActivity = nNow;
+		}
+		long long nFrames, nFrameBytes;
+		unsigned int nSalt;
+		double nWalBytes = ring_libsql_maint_walsize(pMaint, &nFrames, &nSalt, &nFrameBytes);
+		/* Frames of the current WAL generation that the last checkpoint did not copy back */
+		int lSameWal = nSalt == nCheckpointSalt;
+		long long nPending = nFrames - (lSameWal ? nBackfilled : 0);
+		/* A checkpoint held back by a reader is retried on new frames or on the interval, not on every tick */
+		int lGrew = !lSameWal || nFrames > nCheckpointFrames;
+		if (nPending > 0 &&
+			((pMaint->config.nWalSize > 0 && lGrew && nPending * nFrameBytes >= pMaint->config.nWalSize) ||
+			 (pMaint->config.nInterval > 0 && nNow - nLastCheckpoint >= pMaint->config.nInterval)))
+		{
+			long long nCopied = ring_libsql_maint_checkpoint(pMaint);
+			nLastCheckpoint = ring_libsql_now_ms();
+			if (nCopied >= 0)
+			{
+				nCheckpointSalt = nSalt;
+				nCheckpointFrames = nFrames;
+				nBackfilled = nCopied;
+				nPending = nFrames > nCopied ? nFrames - nCopied : 0;
+			}
+		}
+		if (pMaint->config.nVacuumPages > 0 && nNow - nLastActivity >= pMaint->config.nVacuumIdle)
+		{
+			ring_libsql_maint_vacuum(pMaint);
+		}
+		ring_libsql_mutex_lock(&pMaint->mutex);
+		pMaint->stats.nTicks++;
+		pMaint->stats.nWalBytes = nWalBytes;
+		pMaint->stats.nWalPendingFrames = nPending > 0 ? (double)nPending : 0;
+		pMaint->stats.nIdleMs = nNow - nLastActivity;
+		ring_libsql_mutex_unlock(&pMaint->mutex);
+	}
+	RING_LIBSQL_THREAD_RETURN;
+}
+
+static void ring_libsql_maint_free(RingLibSQLMaint *pMaint)
+{
+	if (pMaint->conn)
+	{
+		libsql_disconnect(pMaint->conn);
+	}
+	ring_libsql_mutex_destroy(&pMaint->mutex);
+	free(pMaint->cWalPath);
+	free(pMaint);
+}
+
+/* Starts the worker on its own connection; returns NULL and sets err_msg on failure. The connection gets the
+   database profile like ring_libsql_connect(), and waits up to 1 s for locks when the profile sets no
+   busy_timeout, so a checkpoint does not fail on the first lock it meets */
+static RingLibSQLMaint *ring_libsql_maint_start(libsql_database_t db, RingLibSQLProfile *pProfile,
+												RingLibSQLMaintConfig *pConfig, const char **err_msg)
+{
+	RingLibSQLProfile profile = *pProfile;
+	libsql_rows_t rows;
+	libsql_row_t row = NULL;
+	RingLibSQLMaint *pMaint = (RingLibSQLMaint *)calloc(1, sizeof(RingLibSQLMaint));
+	if (!pMaint)
+	{
+		*err_msg = "Out of memory";
+		return NULL;
+	}
+	ring_libsql_mutex_init(&pMaint->mutex);
+	pMaint->config = *pConfig;
+	int rc = libsql_connect(db, &pMaint->conn, err_msg);
+	if (rc != 0)
+	{
+		pMaint->conn = NULL;
+		ring_libsql_maint_free(pMaint);
+		return NULL;
+	}
+	if (!(profile.nFlags & RING_LIBSQL_PROFILE_BUSY_TIMEOUT))
+	{
+		profile.nFlags |= RING_LIBSQL_PROFILE_BUSY_TIMEOUT;
+		profile.nBusyTimeout = RING_LIBSQL_MAINT_BUSY_TIMEOUT_MS;
+	}
+	if (ring_libsql_profile_apply(&profile, pMaint->conn, err_msg) != 0)
+	{
+		ring_libsql_maint_free(pMaint);
+		return NULL;
+	}
+	/* The main database file (empty for in-memory databases) locates the WAL file */
+	rc = libsql_query(pMaint->conn, "SELECT file FROM pragma_database_list WHERE name = 'main'", &rows, err_msg);
+	if (rc == 0)
+	{
+		const char *cFile = NULL;
+		rc = libsql_next_row(rows, &row, err_msg);
+		if (rc == 0 && row && libsql_get_string(row, 0, &cFile, err_msg) == 0)
+		{
+			if (*cFile)
+			{
+				pMaint->cWalPath = ring_libsql_sprintf("%s-wal", cFile);
+			}
+			libsql_free_string(cFile);
+		}
+		if (row)
+		{
+			libsql_free_row(row);
+		}
+		libsql_free_rows(rows);
+	}
+	if (rc != 0 || !ring_libsql_thread_start(&pMaint->thread, ring_libsql_maint_thread, pMaint))
+	{
+		if (rc == 0)
+		{
+			*err_msg = "Failed to start the maintenance thread";
+		}
+		ring_libsql_maint_free(pMaint);
+		return NULL;
+	}
+	return pMaint;
+}
+
+static void ring_libsql_maint_stop(RingLibSQLMaint *pMaint)
+{
+	ring_libsql_mutex_lock(&pMaint->mutex);
+	pMaint->lStop = 1;
+	ring_libsql_mutex_unlock(&pMaint->mutex);
+	ring_libsql_thread_join(pMaint->thread);
+	ring_libsql_maint_free(pMaint);
+}
+
+/* Replica Sync */
+
+RING_LIBSQL_THREAD_FUNC(ring_libsql_sync_thread)
+{
+	RingLibSQLSync *pSync = (RingLibSQLSync *)pArg;
+	const char *err_msg;
+	replicated repl;
+	int nState = RING_LIBSQL_SYNC_RUNNING;
+	while (nState == RING_LIBSQL_SYNC_RUNNING)
+	{
+		ring_libsql_mutex_lock(&pSync->mutex);
+		if (pSync->lCancel)
+		{
+			nState = pSync->progress.nState = RING_LIBSQL_SYNC_CANCELLED;
+			pSync->progress.nElapsedMs = ring_libsql_now_ms() - pSync->nStart;
+		}
+		ring_libsql_mutex_unlock(&pSync->mutex);
+		if (nState != RING_LIBSQL_SYNC_RUNNING)
+		{
+			break;
+		}
+		double nPassStart = ring_libsql_now_ms();
+		err_msg = NULL;
+		int rc = libsql_sync2(pSync->db, &repl, &err_msg);
+		double nNow = ring_libsql_now_ms();
+		ring_libsql_mutex_lock(&pSync->mutex);
+		pSync->progress.nPasses++;
+		pSync->progress.nLastPassMs = nNow - nPassStart;
+		pSync->progress.nElapsedMs = nNow - pSync->nStart;
+		if (rc != 0)
+		{
+			snprintf(pSync->progress.cError, sizeof(pSync->progress.cError), "%s", err_msg ? err_msg : "Sync failed");
+			nState = RING_LIBSQL_SYNC_FAILED;
+		}
+		else
+		{
+			pSync->progress.nFrameNo = repl.frame_no;
+			pSync->progress.nFramesSynced += repl.frames_synced;
+			pSync->progress.nBytes = pSync->progress.nFramesSynced * pSync->nPageBytes;
+			if (repl.frame_no >= pSync->nTargetFrame)
+			{
+				nState = RING_LIBSQL_SYNC_DONE;
+			}
+			else if (pSync->nDeadlineMs > 0 && pSync->progress.nElapsedMs >= pSync->nDeadlineMs)
+			{
+				nState = RING_LIBSQL_SYNC_DEADLINE;
+			}
+		}
+		pSync->progress.nState = nState;
+		ring_libsql_mutex_unlock(&pSync->mutex);
+		/* The primary has nothing newer yet, give it time before asking again */
+		if (nState == RING_LIBSQL_SYNC_RUNNING && repl.frames_synced == 0)
+		{
+			ring_libsql_sleep_ms(RING_LIBSQL_SYNC_IDLE_MS);
+		}
+	}
+	RING_LIBSQL_THREAD_RETURN;
+}
+
+static int ring_libsql_sync_state(RingLibSQLSync *pSync)
+{
+	ring_libsql_mutex_lock(&pSync->mutex);
+	int nState = pSync->progress.nState;
+	ring_libsql_mutex_unlock(&pSync->mutex);
+	return nState;
+}
+
+/* Stops after the pass in flight (a libsql_sync2() call cannot be interrupted) and joins the worker */
+static void ring_libsql_sync_stop(RingLibSQLSync *pSync)
+{
+	if (pSync->lThread)
+	{
+		ring_libsql_mutex_lock(&pSync->mutex);
+		pSync->lCancel = 1;
+		ring_libsql_mutex_unlock(&pSync->mutex);
+		ring_libsql_thread_join(pSync->thread);
+		pSync->lThread = 0;
+	}
+}
+
+/* Change Feed */
+
+static void ring_libsql_changes_free(RingLibSQLChangeFeed *pFeed)
+{
+	if (pFeed)
+	{
+		for (int x = 0; x < pFeed->nTables; x++)
+		{
+			free(pFeed->aTables[x]);
+		}
+		free(pFeed->aChanges);
+		free(pFeed);
+	}
+}
+
+static int ring_libsql_changes_find(RingLibSQLChangeFeed *pFeed, const char *cTable)
+{
+	for (int x = 0; x < pFeed->nTables; x++)
+	{
+		if (ring_libsql_equals_nocase(pFeed->aTables[x], cTable))
+		{
+			return x;
+		}
+	}
+	return -1;
+}
+
+/* Creates or drops the three capture triggers of table slot nTable */
+static int ring_libsql_changes_triggers(RingLibSQLConn *pConn, int nTable, int lCreate, const char **err_msg)
+{
+	static const char *aNames[] = {"insert", "update", "delete"};
+	static const int aOps[] = {RING_LIBSQL_CHANGE_INSERT, RING_LIBSQL_CHANGE_UPDATE, RING_LIBSQL_CHANGE_DELETE};
+	char *cTable = NULL;
+	int rc = 0;
+	if (lCreate)
+	{
+		cTable = ring_libsql_quote(pConn->pFeed->aTables[nTable], '"');
+		if (!cTable)
+		{
+			*err_msg = "Out of memory";
+			return 1;
+		}
+	}
+	for (int x = 0; x < 3 && rc == 0; x++)
+	{
+		char *cSQL;
+		if (lCreate)
+		{
+			cSQL = ring_libsql_sprintf("CREATE TEMP TRIGGER IF NOT EXISTS ring_libsql_changes_%d_%s AFTER %s ON main.%s "
+									   "BEGIN INSERT INTO ring_libsql_changes (op, tbl, rid) VALUES (%d, %d, %s.rowid); END",
+									   nTable, aNames[x], aNames[x], cTable, aOps[x], nTable, x == 2 ? "OLD" : "NEW");
+		}
+		else
+		{
+			cSQL = ring_libsql_sprintf("DROP TRIGGER IF EXISTS temp.ring_libsql_changes_%d_%s", nTable, aNames[x]);
+		}
+		if (!cSQL)
+		{
+			*err_msg = "Out of memory";
+			rc = 1;
+			break;
+		}
+		rc = libsql_execute(pConn->conn, cSQL, err_msg);
+		free(cSQL);
+	}
+	free(cTable);
+	return rc;
+}
+
+/* Producer side: writes the change past the published tail, or counts an overflow when the ring is full.
+   Staged changes stay invisible to drain until the harvest publishes *pTail */
+static void ring_libsql_changes_stage(RingLibSQLChangeFeed *pFeed, unsigned int *pTail, double *pOverflow,
+									  RingLibSQLChange *pChange)
+{
+	if (*pTail - RING_LIBSQL_LOAD_ACQUIRE(&pFeed->nHead) > pFeed->nMask)
+	{
+		(*pOverflow)++;
+		return;
+	}
+	pFeed->aChanges[*pTail & pFeed->nMask] = *pChange;
+	(*pTail)++;
+}
+
+/* Moves committed rows from the capture table into the ring buffer after a write call.
+   Inside an explicit transaction BEGIN fails, so the rows wait for the call that runs COMMIT
+   (and a ROLLBACK discards them with the rest of the transaction). The staged changes are published only
+   once the DELETE is committed; otherwise the rows stay in the capture table for the next harvest */
+static void ring_libsql_changes_harvest(RingLibSQLConn *pConn)
+{
+	RingLibSQLChangeFeed *pFeed = pConn->pFeed;
+	libsql_rows_t rows;
+	libsql_row_t row;
+	const char *err_msg;
+	long long nSeq, nLast = 0;
+	int lEmpty;
+	if (!pFeed || pFeed->nWatched == 0 || !pConn->conn)
+	{
+		return;
+	}
+	pFeed->lSavedChanges = 0;
+	/* Nothing can have been captured since the last harvest, or an open transaction will publish it at COMMIT */
+	if (!pFeed->lDirty || ring_libsql_in_transaction(pConn))
+	{
+		return;
+	}
+	if (ring_libsql_query_int(pConn->conn, "SELECT seq FROM temp.ring_libsql_changes LIMIT 1", &nSeq, &lEmpty,
+							  &err_msg) != 0)
+	{
+		pFeed->nHarvestErrors++;
+		return;
+	}
+	if (lEmpty)
+	{
+		pFeed->lDirty = 0;
+		return;
+	}
+	if (libsql_execute(pConn->conn, "BEGIN", &err_msg) != 0)
+	{
+		pFeed->nHarvestErrors++;
+		return;
+	}
+	/* The DELETE below resets libsql_changes(), keep the value of the caller's statement */
+	pFeed->nSavedChanges = (double)libsql_changes(pConn->conn);
+	pFeed->lSavedChanges = 1;
+	pFeed->nHarvests++;
+	unsigned int nTail = pFeed->nTail;
+	double nOverflow = 0;
+	int rc = libsql_query(pConn->conn, "SELECT seq, op, tbl, rid FROM temp.ring_libsql_changes ORDER BY seq", &rows,
+						  &err_msg);
+	if (rc == 0)
+	{
+		while ((rc = libsql_next_row(rows, &row, &err_msg)) == 0 && row)
+		{
+			RingLibSQLChange change;
+			long long nOp = 0, nTable = 0;
+			rc = libsql_get_int(row, 0, &nSeq, &err_msg);
+			if (rc == 0)
+			{
+				rc = libsql_get_int(row, 1, &nOp, &err_msg);
+			}
+			if (rc == 0)
+			{
+				rc = libsql_get_int(row, 2, &nTable, &err_msg);
+			}
+			if (rc == 0)
+			{
+				rc = libsql_get_int(row, 3, &change.nRowID, &err_msg);
+			}
+			libsql_free_row(row);
+			if (rc != 0)
+			{
+				break;
+			}
+			change.nOp = (int)nOp;
+			change.nTable = (int)nTable;
+			ring_libsql_changes_stage(pFeed, &nTail, &nOverflow, &change);
+			nLast = nSeq;
+		}
+		libsql_free_rows(rows);
+	}
+	if (rc == 0 && nLast > 0)
+	{
+		char cSQL[80];
+		snprintf(cSQL, sizeof(cSQL), "DELETE FROM temp.ring_libsql_changes WHERE seq <= %lld", nLast);
+		rc = libsql_execute(pConn->conn, cSQL, &err_msg);
+	}
+	if (rc == 0)
+	{
+		rc = libsql_execute(pConn->conn, "COMMIT", &err_msg);
+	}
+	if (rc != 0)
+	{
+		libsql_execute(pConn->conn, "ROLLBACK", &err_msg);
+		pFeed->nHarvestErrors++;
+		return;
+	}
+	pFeed->lDirty = 0;
+	pFeed->nCaptured += (double)(nTail - pFeed->nTail);
+	pFeed->nOverflow += nOverflow;
+	RING_LIBSQL_STORE_RELEASE(&pFeed->nTail, nTail);
+}
+
+/* Flags the feed after a statement that changed rows, since only those can fire a watched trigger */
+static void ring_libsql_changes_mark(RingLibSQLConn *pConn, const char *cSQL)
+{
+	if (pConn->pFeed && ring_libsql_sql_writes(cSQL) && libsql_changes(pConn->conn) > 0)
+	{
+		pConn->pFeed->lDirty = 1;
+	}
+}
+
+/* The rows of a write run through query() are done: its changes count is not reliable here, so any write counts */
+static void ring_libsql_rows_harvest(RingLibSQLRows *pRows)
+{
+	if (pRows->lWrites && pRows->pConn->pFeed)
+	{
+		pRows->pConn->pFeed->lDirty = 1;
+	}
+	ring_libsql_changes_harvest(pRows->pConn);
+}
+
+/* Query Plans */
+
+static void ring_libsql_plan_free(RingLibSQLPlanStep *aPlan, int nPlan)
+{
+	for (int x = 0; x < nPlan; x++)
+	{
+		free(aPlan[x].cDetail);
+	}
+	free(aPlan);
+}
+
+/* Runs EXPLAIN QUERY PLAN on cSQL; the steps are returned in a malloc'd array owned by the caller */
+static int ring_libsql_plan_capture(libsql_connection_t conn, const char *cSQL, RingLibSQLPlanStep **paPlan,
+									int *pnPlan, const char **err_msg)
+{
+	libsql_rows_t rows;
+	libsql_row_t row;
+	RingLibSQLPlanStep *aPlan = NULL;
+	int nPlan = 0, nCapacity = 0;
+	*paPlan = NULL;
+	*pnPlan = 0;
+	char *cExplain = ring_libsql_sprintf("EXPLAIN QUERY PLAN %s", cSQL);
+	if (!cExplain)
+	{
+		*err_msg = "Out of memory";
+		return 1;
+	}
+	int rc = libsql_query(conn, cExplain, &rows, err_msg);
+	free(cExplain);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	while ((rc = libsql_next_row(rows, &row, err_msg)) == 0 && row)
+	{
+		long long nID = 0, nParent = 0;
+		const char *cDetail = NULL;
+		rc = libsql_get_int(row, 0, &nID, err_msg);
+		if (rc == 0)
+		{
+			rc = libsql_get_int(row, 1, &nParent, err_msg);
+		}
+		if (rc == 0)
+		{
+			rc = libsql_get_string(row, 3, &cDetail, err_msg);
+		}
+		if (rc == 0 && nPlan == nCapacity)
+		{
+			nCapacity = nCapacity ? nCapacity * 2 : 8;
+			RingLibSQLPlanStep *aGrown = (RingLibSQLPlanStep *)realloc(aPlan, nCapacity * sizeof(RingLibSQLPlanStep));
+			if (aGrown)
+			{
+				aPlan = aGrown;
+			}
+			else
+			{
+				*err_msg = "Out of memory";
+				rc = 1;
+			}
+		}
+		if (rc == 0)
+		{
+			aPlan[nPlan].nID = (int)nID;
+			aPlan[nPlan].nParent = (int)nParent;
+			aPlan[nPlan].cDetail = ring_libsql_strdup(cDetail ? cDetail : "");
+			if (aPlan[nPlan++].cDetail == NULL)
+			{
+				*err_msg = "Out of memory";
+				rc = 1;
+			}
+		}
+		if (cDetail)
+		{
+			libsql_free_string(cDetail);
+		}
+		libsql_free_row(row);
+		if (rc != 0)
+		{
+			break;
+		}
+	}
+	libsql_free_rows(rows);
+	if (rc != 0)
+	{
+		ring_libsql_plan_free(aPlan, nPlan);
+		return rc;
+	}
+	*paPlan = aPlan;
+	*pnPlan = nPlan;
+	return 0;
+}
+
+/* Appends the plan steps to pList as [id, parent, detail] */
+static void ring_libsql_plan_addlist(List *pList, RingLibSQLPlanStep *aPlan, int nPlan)
+{
+	for (int x = 0; x < nPlan; x++)
+	{
+		List *pItem = ring_list_newlist(pList);
+		ring_list_adddouble(pItem, aPlan[x].nID);
+		ring_list_adddouble(pItem, aPlan[x].nParent);
+		ring_list_addstring(pItem, aPlan[x].cDetail);
+	}
+}
+
+/* Appends the EXPLAIN QUERY PLAN rows of cSQL to pList as [id, parent, detail] */
+static int ring_libsql_explain_list(libsql_connection_t conn, const char *cSQL, List *pList, const char **err_msg)
+{
+	RingLibSQLPlanStep *aPlan;
+	int nPlan;
+	int rc = ring_libsql_plan_capture(conn, cSQL, &aPlan, &nPlan, err_msg);
+	if (rc == 0)
+	{
+		ring_libsql_plan_addlist(pList, aPlan, nPlan);
+		ring_libsql_plan_free(aPlan, nPlan);
+	}
+	return rc;
+}
+
+static void ring_libsql_advisor_entry_free(RingLibSQLAdvisorEntry *pEntry)
+{
+	free(pEntry->cSQL);
+	ring_libsql_plan_free(pEntry->aPlan, pEntry->nPlan);
+	free(pEntry->cPlanError);
+}
+
+/* Keeps the plan the statement ran with when it became expensive, so later schema changes
+   (such as the index the report suggests) do not rewrite what was measured */
+static void ring_libsql_advisor_capture(RingLibSQLConn *pConn, RingLibSQLAdvisorEntry *pEntry)
+{
+	const char *err_msg = "";
+	pEntry->lPlan = 1;
+	if (ring_libsql_plan_capture(pConn->conn, pEntry->cSQL, &pEntry->aPlan, &pEntry->nPlan, &err_msg) != 0)
+	{
+		pEntry->cPlanError = ring_libsql_strdup(err_msg ? err_msg : "");
+	}
+}
+
+static void ring_libsql_advisor_free(RingLibSQLAdvisor *pAdvisor)
+{
+	if (pAdvisor)
+	{
+		for (int x = 0; x < pAdvisor->nEntries; x++)
+		{
+			ring_libsql_advisor_entry_free(&pAdvisor->aEntries[x]);
+		}
+		free(pAdvisor->aEntries);
+		free(pAdvisor);
+	}
+}
+
+static unsigned int ring_libsql_hash(const char *cStr)
+{
+	unsigned int nHash = 2166136261u;
+	while (*cStr)
+	{
+		nHash = (nHash ^ (unsigned char)*cStr++) * 16777619u;
+	}
+	return nHash;
+}
+
+/* Picks the entry that makes room in a full table. A statement seen once is kept until it gets a second call,
+   so the least total time among repeated statements goes first, and the oldest entry when none has repeated */
+static RingLibSQLAdvisorEntry *ring_libsql_advisor_victim(RingLibSQLAdvisor *pAdvisor)
+{
+	RingLibSQLAdvisorEntry *pVictim = NULL;
+	RingLibSQLAdvisorEntry *pOldest = &pAdvisor->aEntries[0];
+	for (int x = 0; x < pAdvisor->nEntries; x++)
+	{
+		RingLibSQLAdvisorEntry *pEntry = &pAdvisor->aEntries[x];
+		if (pEntry->nCalls > 1 && (!pVictim || pEntry->nTotalMs < pVictim->nTotalMs))
+		{
+			pVictim = pEntry;
+		}
+		if (pEntry->nSeq < pOldest->nSeq)
+		{
+			pOldest = pEntry;
+		}
+	}
+	return pVictim ? pVictim : pOldest;
+}
+
+/* Adds one timed call. lCapture is 0 when the caller may be inside another statement or the GC (rows being
+   freed), so the plan is left to advisorReport() instead of running EXPLAIN at that point */
+static void ring_libsql_advisor_record(RingLibSQLConn *pConn, const char *cSQL, double nMs, int lCapture)
+{
+	RingLibSQLAdvisor *pAdvisor = pConn->pAdvisor;
+	RingLibSQLAdvisorEntry *pEntry = NULL;
+	if (!pAdvisor || !cSQL)
+	{
+		return;
+	}
+	unsigned int nHash = ring_libsql_hash(cSQL);
+	for (int x = 0; x < pAdvisor->nEntries; x++)
+	{
+		if (pAdvisor->aEntries[x].nHash == nHash && strcmp(pAdvisor->aEntries[x].cSQL, cSQL) == 0)
+		{
+			pEntry = &pAdvisor->aEntries[x];
+			break;
+		}
+	}
+	if (!pEntry)
+	{
+		char *cCopy = ring_libsql_strdup(cSQL);
+		if (!cCopy)
+		{
+			return;
+		}
+		if (pAdvisor->nEntries < pAdvisor->nCapacity)
+		{
+			pEntry = &pAdvisor->aEntries[pAdvisor->nEntries++];
+		}
+		else
+		{
+			pEntry = ring_libsql_advisor_victim(pAdvisor);
+			ring_libsql_advisor_entry_free(pEntry);
+		}
+		memset(pEntry, 0, sizeof(RingLibSQLAdvisorEntry));
+		pEntry->cSQL = cCopy;
+		pEntry->nHash = nHash;
+		pEntry->nSeq = pAdvisor->nInserts++;
+	}
+	pEntry->nCalls++;
+	pEntry->nTotalMs += nMs;
+	if (nMs > pEntry->nMaxMs)
+	{
+		pEntry->nMaxMs = nMs;
+	}
+	if (lCapture && !pEntry->lPlan && pConn->conn)
+	{
+		int nAbove = 0;
+		for (int x = 0; x < pAdvisor->nEntries && nAbove < pAdvisor->nTop; x++)
+		{
+			nAbove += pAdvisor->aEntries[x].nTotalMs > pEntry->nTotalMs;
+		}
+		if (nAbove < pAdvisor->nTop)
+		{
+			ring_libsql_advisor_capture(pConn, pEntry);
+		}
+	}
+}
+
+/* A query is recorded once its rows are read to the end or freed, since stepping does most of the work.
+   Its plan is captured by advisorReport(), the rows may still be open or freed by the GC here */
+static void ring_libsql_rows_advise(RingLibSQLRows *pRows)
+{
+	if (pRows->cAdvisorSQL)
+	{
+		ring_libsql_advisor_record(pRows->pConn, pRows->cAdvisorSQL, pRows->nAdvisorMs, 0);
+		free(pRows->cAdvisorSQL);
+		pRows->cAdvisorSQL = NULL;
+	}
+}
+
+static int ring_libsql_advisor_compare(const void *pA, const void *pB)
+{
+	double nA = ((const RingLibSQLAdvisorEntry *)pA)->nTotalMs;
+	double nB = ((const RingLibSQLAdvisorEntry *)pB)->nTotalMs;
+	return (nA < nB) - (nA > nB);
+}
+
+/* Splits SQL into identifiers and keywords (quotes removed); string literals, numbers and
+   punctuation are skipped. Returns a malloc'd array of malloc'd strings, or NULL */
+static char **ring_libsql_sql_words(const char *cSQL, int *pCount)
+{
+	char **aWords = NULL;
+	int nCount = 0, nCapacity = 0;
+	const char *p = cSQL;
+	*pCount = 0;
+	while (*p)
+	{
+		const char *cStart;
+		size_t nLen;
+		char cClose = 0;
+		if (*p == '\'')
+		{
+			for (p++; *p && !(*p == '\'' && p[1] != '\''); p += (*p == '\'') ? 2 : 1)
+				;
+			p += *p != 0;
+			continue;
+		}
+		if (*p == '"' || *p == '`' || *p == '[')
+		{
+			cClose = *p == '[' ? ']' : *p;
+			cStart = ++p;
+			while (*p && *p != cClose)
+			{
+				p++;
+			}
+			nLen = (size_t)(p - cStart);
+			p += *p != 0;
+		}
+		else if (isalpha((unsigned char)*p) || *p == '_')
+		{
+			cStart = p;
+			while (isalnum((unsigned char)*p) || *p == '_' || *p == '$')
+			{
+				p++;
+			}
+			nLen = (size_t)(p - cStart);
+		}
+		else
+		{
+			/* Numbers are skipped whole so 1e5 or 0x1F do not produce words */
+			if (isdigit((unsigned char)*p))
+			{
+				while (isalnum((unsigned char)*p) || *p == '.')
+				{
+					p++;
+				}
+			}
+			else
+			{
+				p++;
+			}
+			continue;
+		}
+		if (nCount == nCapacity)
+		{
+			int nNew = nCapacity ? nCapacity * 2 : 32;
+			char **aNew = (char **)realloc(aWords, nNew * sizeof(char *));
+			if (!aNew)
+			{
+				break;
+			}
+			aWords = aNew;
+			nCapacity = nNew;
+		}
+		aWords[nCount] = (char *)malloc(nLen + 1);
+		if (!aWords[nCount])
+		{
+			break;
+		}
+		memcpy(aWords[nCount], cStart, nLen);
+		aWords[nCount++][nLen] = '\0';
+	}
+	*pCount = nCount;
+	return aWords;
+}
+
+static void ring_libsql_sql_words_free(char **aWords, int nCount)
+{
+	for (int x = 0; x < nCount; x++)
+	{
+		free(aWords[x]);
+	}
+	free(aWords);
+}
+
+static int ring_libsql_table_exists(libsql_connection_t conn, const char *cTable)
+{
+	const char *err_msg;
+	long long nCount = 0;
+	int lNull;
+	char *cName = ring_libsql_quote(cTable, '\'');
+	char *cSQL = cName ? ring_libsql_sprintf("SELECT count(*) FROM main.sqlite_schema WHERE type = 'table' AND "
+											 "name = %s COLLATE NOCASE",
+											 cName)
+					   : NULL;
+	free(cName);
+	if (cSQL)
+	{
+		ring_libsql_query_int(conn, cSQL, &nCount, &lNull, &err_msg);
+		free(cSQL);
+	}
+	return nCount > 0;
+}
+
+/* Checks one plan line; a full SCAN of a table with at least nMinRows rows is added to pScans as
+   [table, rows, candidate columns]. Candidates are the table's columns named after WHERE / ON / BY
+   that do not already lead an index */
+static void ring_libsql_advisor_scan(libsql_connection_t conn, char **aWords, int nWords, const char *cDetail,
+									 double nMinRows, List *pScans)
+{
+	const char *err_msg;
+	char cName[256];
+	long long nRows = 0;
+	int lNull = 1;
+	if (strncmp(cDetail, "SCAN ", 5) != 0 || cDetail[5] == '(' || strstr(cDetail, " USING ") ||
+		strstr(cDetail, " VIRTUAL TABLE"))
+	{
+		return;
+	}
+	snprintf(cName, sizeof(cName), "%s", cDetail + 5);
+	char *cSpace = strchr(cName, ' ');
+	if (cSpace)
+	{
+		*cSpace = '\0';
+	}
+	/* The plan names tables by their alias, map it back through "table [AS] alias" in the SQL */
+	if (!ring_libsql_table_exists(conn, cName))
+	{
+		int lFound = 0;
+		for (int x = 1; x < nWords && !lFound; x++)
+		{
+			if (ring_libsql_equals_nocase(aWords[x], cName))
+			{
+				int nTable = (ring_libsql_equals_nocase(aWords[x - 1], "AS") && x > 1) ? x - 2 : x - 1;
+				if (ring_libsql_table_exists(conn, aWords[nTable]))
+				{
+					snprintf(cName, sizeof(cName), "%s", aWords[nTable]);
+					lFound = 1;
+				}
+			}
+		}
+		if (!lFound)
+		{
+			return;
+		}
+	}
+	char *cQuoted = ring_libsql_quote(cName, '"');
+	char *cLiteral = ring_libsql_quote(cName, '\'');
+	char *cSQL = cQuoted ? ring_libsql_sprintf("SELECT max(rowid) FROM main.%s", cQuoted) : NULL;
+	if (cSQL && ring_libsql_query_int(conn, cSQL, &nRows, &lNull, &err_msg) != 0)
+	{
+		/* WITHOUT ROWID tables have to be counted */
+		free(cSQL);
+		cSQL = ring_libsql_sprintf("SELECT count(*) FROM main.%s", cQuoted);
+		if (cSQL)
+		{
+			ring_libsql_query_int(conn, cSQL, &nRows, &lNull, &err_msg);
+		}
+	}
+	free(cSQL);
+	cSQL = NULL;
+	if ((double)nRows < nMinRows || !cLiteral)
+	{
+		free(cQuoted);
+		free(cLiteral);
+		return;
+	}
+	List *pItem = ring_list_newlist(pScans);
+	ring_list_addstring(pItem, cName);
+	ring_list_adddouble(pItem, (double)nRows);
+	List *pColumns = ring_list_newlist(pItem);
+	cSQL = ring_libsql_sprintf("SELECT c.name FROM pragma_table_info(%s) c WHERE NOT (c.pk = 1 AND upper(c.type) = "
+							   "'INTEGER') AND c.name NOT IN (SELECT ii.name FROM pragma_index_list(%s) il, "
+							   "pragma_index_info(il.name) ii WHERE ii.seqno = 0)",
+							   cLiteral, cLiteral);
+	free(cQuoted);
+	free(cLiteral);
+	int nFilter = nWords;
+	for (int x = 0; x < nWords; x++)
+	{
+		if (ring_libsql_equals_nocase(aWords[x], "WHERE") || ring_libsql_equals_nocase(aWords[x], "ON") ||
+			ring_libsql_equals_nocase(aWords[x], "BY"))
+		{
+			nFilter = x + 1;
+			break;
+		}
+	}
+	libsql_rows_t rows;
+	libsql_row_t row;
+	if (!cSQL || libsql_query(conn, cSQL, &rows, &err_msg) != 0)
+	{
+		free(cSQL);
+		return;
+	}
+	free(cSQL);
+	while (libsql_next_row(rows, &row, &err_msg) == 0 && row)
+	{
+		const char *cColumn = NULL;
+		if (libsql_get_string(row, 0, &cColumn, &err_msg) == 0 && cColumn)
+		{
+			for (int x = nFilter; x < nWords; x++)
+			{
+				if (ring_libsql_equals_nocase(aWords[x], cColumn))
+				{
+					ring_list_addstring(pColumns, cColumn);
+					break;
+				}
+			}
+			libsql_free_string(cColumn);
+		}
+		libsql_free_row(row);
+	}
+	libsql_free_rows(rows);
+}
+
+/* Free Functions for Managed Pointers */
+
+void ring_libsql_free_db(void *pState, void *pPtr)
+{
+	RingLibSQLDB *pDB = (RingLibSQLDB *)pPtr;
+	if (pDB)
+	{
+		if (pDB->pMaint)
+		{
+			ring_libsql_maint_stop(pDB->pMaint);
+		}
+		if (pDB->pSync)
+		{
+			ring_libsql_sync_stop(pDB->pSync);
+			pDB->pSync->pDB = NULL;
+		}
+		libsql_close(pDB->db);
+		free(pDB);
+	}
+}
+
+void ring_libsql_free_conn(void *pState, void *pPtr)
+{
+	RingLibSQLConn *pConn = (RingLibSQLConn *)pPtr;
+	if (pConn)
+	{
+		if (pConn->conn)
+		{
+			libsql_disconnect(pConn->conn);
+			pConn->conn = NULL;
+		}
+		ring_libsql_conn_release(pConn);
+	}
+}
+
+void ring_libsql_free_stmt(void *pState, void *pPtr)
+{
+	RingLibSQLStmt *pStmt = (RingLibSQLStmt *)pPtr;
+	if (pStmt)
+	{
+		libsql_free_stmt(pStmt->stmt);
+		ring_libsql_conn_release(pStmt->pConn);
+		free(pStmt->cSQL);
+		free(pStmt);
+	}
+}
+
+void ring_libsql_free_rows(void *pState, void *pPtr)
+{
+	RingLibSQLRows *pRows = (RingLibSQLRows *)pPtr;
+	if (pRows)
+	{
+		if (pRows->row)
+		{
+			libsql_free_row(pRows->row);
+		}
+		if (pRows->rows)
+		{
+			libsql_free_rows(pRows->rows);
+		}
+		/* Freeing rows that were not read to the end finishes their statement, which may commit a write */
+		if (!pRows->lDone)
+		{
+			ring_libsql_rows_harvest(pRows);
+		}
+		ring_libsql_rows_advise(pRows);
+		ring_libsql_conn_release(pRows->pConn);
+		free(pRows);
+	}
+}
+
+void ring_libsql_free_row(void *pState, void *pPtr)
+{
+	RingLibSQLRow *pRow = (RingLibSQLRow *)pPtr;
+	if (pRow)
+	{
+		libsql_free_row(pRow->row);
+		free(pRow);
+	}
+}
+
+void ring_libsql_free_backup(void *pState, void *pPtr)
+{
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)pPtr;
+	if (pBackup)
+	{
+		ring_libsql_backup_close(pBackup);
+		ring_libsql_mutex_destroy(&pBackup->mutex);
+		free(pBackup->cDest);
+		free(pBackup);
+	}
+}
+
+void ring_libsql_free_sync(void *pState, void *pPtr)
+{
+	RingLibSQLSync *pSync = (RingLibSQLSync *)pPtr;
+	if (pSync)
+	{
+		ring_libsql_sync_stop(pSync);
+		if (pSync->pDB)
+		{
+			pSync->pDB->pSync = NULL;
+		}
+		ring_libsql_mutex_destroy(&pSync->mutex);
+		free(pSync);
+	}
+}
+
+/* Database Helpers */
+
+/* close() frees the database handle and clears the Ring pointer */
+static RingLibSQLDB *ring_libsql_get_db(void *pPointer, int nPara)
+{
+	RingLibSQLDB *pDB = (RingLibSQLDB *)RING_API_GETCPOINTER(nPara, RING_POINTER_LIBSQL_DB);
+	if (!pDB)
+	{
+		RING_API_ERROR("Database is closed");
+		return NULL;
+	}
+	return pDB;
+}
+
+static void ring_libsql_ret_db(void *pPointer, libsql_database_t db, RingLibSQLProfile *pProfile)
+{
+	RingLibSQLDB *pDB = (RingLibSQLDB *)calloc(1, sizeof(RingLibSQLDB));
+	if (!pDB)
+	{
+		libsql_close(db);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	pDB->db = db;
+	if (pProfile)
+	{
+		pDB->profile = *pProfile;
+	}
+	RING_API_RETMANAGEDCPOINTER(pDB, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+}
+
+/* Int64 Transport */
+
+/* Writes value in the given transport mode to cOut (at least 21 bytes), returns the length */
+static int ring_libsql_int64_format(long long value, int nMode, char *cOut)
+{
+	if (nMode == RING_LIBSQL_INT64_PACKED)
+	{
+		unsigned long long nBits = (unsigned long long)value;
+		for (int x = 0; x < 8; x++)
+		{
+			cOut[x] = (char)((nBits >> (8 * x)) & 0xFF);
+		}
+		return 8;
+	}
+	return snprintf(cOut, 21, "%lld", value);
+}
+
+static long long ring_libsql_int64_read(const char *pData)
+{
+	unsigned long long nBits = 0;
+	for (int x = 0; x < 8; x++)
+	{
+		nBits |= (unsigned long long)(unsigned char)pData[x] << (8 * x);
+	}
+	return (long long)nBits;
+}
+
+/* Parses a whole decimal string into *pValue, returns 0 when it is not an in-range integer */
+static int ring_libsql_int64_parse(const char *cStr, long long *pValue)
+{
+	char *pEnd;
+	if (!cStr || !*cStr || isspace((unsigned char)*cStr))
+	{
+		return 0;
+	}
+	errno = 0;
+	*pValue = strtoll(cStr, &pEnd, 10);
+	return errno == 0 && *pEnd == '\0';
+}
+
+/* Vector Helpers */
+
+/* Stores a float as 4 little-endian bytes, the layout of libsql F32_BLOB vectors */
+static void ring_libsql_float32_write(char *pOut, double nValue)
+{
+	float nFloat = (float)nValue;
+	unsigned int nBits;
+	memcpy(&nBits, &nFloat, 4);
+	for (int x = 0; x < 4; x++)
+	{
+		pOut[x] = (char)((nBits >> (8 * x)) & 0xFF);
+	}
+}
+
+static double ring_libsql_float32_read(const char *pData)
+{
+	unsigned int nBits = 0;
+	float nFloat;
+	for (int x = 0; x < 4; x++)
+	{
+		nBits |= (unsigned int)(unsigned char)pData[x] << (8 * x);
+	}
+	memcpy(&nFloat, &nBits, 4);
+	return nFloat;
+}
+
+/* Packs a Ring list of numbers into pOut (4 bytes per item); returns 0 on a non-number item */
+static int ring_libsql_vector_write(char *pOut, List *pList)
+{
+	for (int x = 1; x <= ring_list_getsize(pList); x++)
+	{
+		if (!ring_list_isnumber(pList, x))
+		{
+			return 0;
+		}
+		ring_libsql_float32_write(pOut + (x - 1) * 4, ring_list_getdouble(pList, x));
+	}
+	return 1;
+}
+
+/* Binds a vector given as a list of numbers or an already packed float32 string */
+static int ring_libsql_stmt_bind_vector(libsql_stmt_t stmt, RingLibSQLArena *pArena, int nIndex, List *pList,
+										const char *pPacked, int nPacked, const char **err_msg)
+{
+	if (pList)
+	{
+		/* The blob is copied by libsql_bind_blob, so arena scratch memory is enough */
+		nPacked = ring_list_getsize(pList) * 4;
+		char *pData = (char *)ring_libsql_arena_alloc(pArena, (size_t)nPacked + 1);
+		if (!pData || !ring_libsql_vector_write(pData, pList))
+		{
+			*err_msg = pData ? "A vector must be a list of numbers" : "Out of memory";
+			return 1;
+		}
+		pPacked = pData;
+	}
+	else if (nPacked % 4 != 0)
+	{
+		*err_msg = "A packed vector must hold a whole number of float32 values";
+		return 1;
+	}
+	return libsql_bind_blob(stmt, nIndex, (const unsigned char *)pPacked, nPacked, err_msg);
+}
+
+/* Memory Accounting */
+
+/* Estimated Ring cost of one list item and of one row list, on top of the value payload */
+#define RING_LIBSQL_MEMORY_ITEM_BYTES 32
+#define RING_LIBSQL_MEMORY_ROW_BYTES 64
+
+#define RING_LIBSQL_MEMORY_OK 0
+#define RING_LIBSQL_MEMORY_SOFT 1
+#define RING_LIBSQL_MEMORY_HARD 2
+
+/* Every fetch or get call is measured on its own, nCurrent holds the bytes of the latest one */
+static void ring_libsql_memory_begin(RingLibSQLConn *pConn)
+{
+	pConn->memory.nCurrent = 0;
+	pConn->memory.nChunk = 0;
+}
+
+/* Starts the next chunk of the same fetch: the soft limit counts again from zero, while the hard limit keeps
+   applying to the running total of every chunk so far */
+static void ring_libsql_memory_continue(RingLibSQLConn *pConn)
+{
+	pConn->memory.nChunk = 0;
+}
+
+static int ring_libsql_memory_reject(RingLibSQLConn *pConn)
+{
+	RingLibSQLMemory *pMemory = &pConn->memory;
+	pMemory->nRejected++;
+	snprintf(pMemory->cError, sizeof(pMemory->cError), "Result exceeds the hard memory limit of %.0f bytes",
+			 pMemory->nHardLimit);
+	return RING_LIBSQL_MEMORY_HARD;
+}
+
+/* Checks nBytes more against the hard limit before they are handed to Ring, without charging them */
+static int ring_libsql_memory_check(RingLibSQLConn *pConn, double nBytes)
+{
+	RingLibSQLMemory *pMemory = &pConn->memory;
+	if (pMemory->nHardLimit > 0 && pMemory->nCurrent + nBytes > pMemory->nHardLimit)
+	{
+		return ring_libsql_memory_reject(pConn);
+	}
+	return RING_LIBSQL_MEMORY_OK;
+}
+
+/* Charges nBytes to the running call; HARD leaves the bytes uncounted and sets memory.cError */
+static int ring_libsql_memory_add(RingLibSQLConn *pConn, double nBytes)
+{
+	RingLibSQLMemory *pMemory = &pConn->memory;
+	if (ring_libsql_memory_check(pConn, nBytes) == RING_LIBSQL_MEMORY_HARD)
+	{
+		return RING_LIBSQL_MEMORY_HARD;
+	}
+	pMemory->nCurrent += nBytes;
+	pMemory->nChunk += nBytes;
+	pMemory->nTotal += nBytes;
+	if (pMemory->nCurrent > pMemory->nPeak)
+	{
+		pMemory->nPeak = pMemory->nCurrent;
+	}
+	if (pMemory->nSoftLimit > 0 && pMemory->nChunk >= pMemory->nSoftLimit)
+	{
+		return RING_LIBSQL_MEMORY_SOFT;
+	}
+	return RING_LIBSQL_MEMORY_OK;
+}
+
+/* Rows Helpers */
+
+/* The soft limit ends the call early, the remaining rows stay in the cursor for the next fetch */
+static void ring_libsql_rows_chunk(RingLibSQLRows *pRows)
+{
+	pRows->lMore = 1;
+	pRows->pConn->memory.nChunks++;
+}
+
+/* nStart is when the query call began, used by the index advisor */
+static void ring_libsql_ret_rows(void *pPointer, RingLibSQLConn *pConn, libsql_rows_t rows, const char *cSQL,
+								 double nStart)
+{
+	RingLibSQLRows *pRows = (RingLibSQLRows *)calloc(1, sizeof(RingLibSQLRows));
+	if (!pRows)
+	{
+		libsql_free_rows(rows);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	pRows->rows = rows;
+	pRows->pConn = ring_libsql_conn_retain(pConn);
+	pRows->lWrites = ring_libsql_sql_writes(cSQL);
+	if (pConn->pAdvisor && cSQL)
+	{
+		pRows->cAdvisorSQL = ring_libsql_strdup(cSQL);
+		pRows->nAdvisorMs = ring_libsql_now_ms() - nStart;
+	}
+	RING_API_RETMANAGEDCPOINTER(pRows, RING_POINTER_LIBSQL_ROWS, ring_libsql_free_rows);
+}
+
+static void ring_libsql_ret_value(void *pPointer, RingLibSQLConn *pConn, libsql_rows_t rows, libsql_row_t row, int col,
+								  int nInt64Mode)
+{
+	int type;
+	const char *err_msg;
+	int rc = libsql_column_type(rows, row, col, &type, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	switch (type)
+	{
+	case LIBSQL_INT: {
+		long long value;
+		rc = libsql_get_int(row, col, &value, &err_msg);
+		LIBSQL_CHECK_OK(rc, err_msg);
+		if (nInt64Mode != RING_LIBSQL_INT64_NUMBER)
+		{
+			char cValue[21];
+			int nLen = ring_libsql_int64_format(value, nInt64Mode, cValue);
+			RING_API_RETSTRING2(cValue, nLen);
+			break;
+		}
+		RING_API_RETNUMBER(value);
+		break;
+	}
+	case LIBSQL_FLOAT: {
+		double value;
+		rc = libsql_get_float(row, col, &value, &err_msg);
+		LIBSQL_CHECK_OK(rc, err_msg);
+		RING_API_RETNUMBER(value);
+		break;
+	}
+	case LIBSQL_TEXT: {
+		const char *value;
+		rc = libsql_get_string(row, col, &value, &err_msg);
+		LIBSQL_CHECK_OK(rc, err_msg);
+		ring_libsql_memory_begin(pConn);
+		if (ring_libsql_memory_add(pConn, RING_LIBSQL_MEMORY_ITEM_BYTES + strlen(value) + 1) ==
+			RING_LIBSQL_MEMORY_HARD)
+		{
+			libsql_free_string(value);
+			RING_API_ERROR(pConn->memory.cError);
+			return;
+		}
+		RING_API_RETSTRING(value);
+		libsql_free_string(value);
+		break;
+	}
+	case LIBSQL_BLOB: {
+		blob b;
+		rc = libsql_get_blob(row, col, &b, &err_msg);
+		LIBSQL_CHECK_OK(rc, err_msg);
+		ring_libsql_memory_begin(pConn);
+		if (ring_libsql_memory_add(pConn, RING_LIBSQL_MEMORY_ITEM_BYTES + b.len + 1) == RING_LIBSQL_MEMORY_HARD)
+		{
+			libsql_free_blob(b);
+			RING_API_ERROR(pConn->memory.cError);
+			return;
+		}
+		RING_API_RETSTRING2(b.ptr, b.len);
+		libsql_free_blob(b);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+/* Adds one column value to pList, NULL becomes an empty string like Ring's null; *pBytes grows by its estimated size.
+   A value that would take the call past the hard limit is rejected before it reaches the list */
+static int ring_libsql_list_addvalue(List *pList, RingLibSQLConn *pConn, libsql_rows_t rows, libsql_row_t row,
+									 int col, int nInt64Mode, double *pBytes, const char **err_msg)
+{
+	int type, nMemory = RING_LIBSQL_MEMORY_OK;
+	int rc = libsql_column_type(rows, row, col, &type, err_msg);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	switch (type)
+	{
+	case LIBSQL_INT: {
+		long long value;
+		rc = libsql_get_int(row, col, &value, err_msg);
+		if (rc == 0 && nInt64Mode != RING_LIBSQL_INT64_NUMBER)
+		{
+			char cValue[21];
+			int nLen = ring_libsql_int64_format(value, nInt64Mode, cValue);
+			rc = nMemory = ring_libsql_memory_check(pConn, *pBytes + RING_LIBSQL_MEMORY_ITEM_BYTES + nLen + 1);
+			if (rc == 0)
+			{
+				ring_list_addstring2(pList, cValue, nLen);
+				*pBytes += RING_LIBSQL_MEMORY_ITEM_BYTES + nLen + 1;
+			}
+		}
+		else if (rc == 0)
+		{
+			rc = nMemory = ring_libsql_memory_check(pConn, *pBytes + RING_LIBSQL_MEMORY_ITEM_BYTES);
+			if (rc == 0)
+			{
+				ring_list_adddouble(pList, (double)value);
+				*pBytes += RING_LIBSQL_MEMORY_ITEM_BYTES;
+			}
+		}
+		break;
+	}
+	case LIBSQL_FLOAT: {
+		double value;
+		rc = libsql_get_float(row, col, &value, err_msg);
+		if (rc == 0)
+		{
+			rc = nMemory = ring_libsql_memory_check(pConn, *pBytes + RING_LIBSQL_MEMORY_ITEM_BYTES);
+		}
+		if (rc == 0)
+		{
+			ring_list_adddouble(pList, value);
+			*pBytes += RING_LIBSQL_MEMORY_ITEM_BYTES;
+		}
+		break;
+	}
+	case LIBSQL_TEXT: {
+		const char *value;
+		rc = libsql_get_string(row, col, &value, err_msg);
+		if (rc == 0)
+		{
+			size_t nLen = strlen(value);
+			rc = nMemory = ring_libsql_memory_check(pConn, *pBytes + RING_LIBSQL_MEMORY_ITEM_BYTES + nLen + 1);
+			if (rc == 0)
+			{
+				ring_list_addstring2(pList, value, nLen);
+				*pBytes += RING_LIBSQL_MEMORY_ITEM_BYTES + nLen + 1;
+			}
+			libsql_free_string(value);
+		}
+		break;
+	}
+	case LIBSQL_BLOB: {
+		blob b;
+		rc = libsql_get_blob(row, col, &b, err_msg);
+		if (rc == 0)
+		{
+			rc = nMemory = ring_libsql_memory_check(pConn, *pBytes + RING_LIBSQL_MEMORY_ITEM_BYTES + b.len + 1);
+			if (rc == 0)
+			{
+				ring_list_addstring2(pList, b.ptr, b.len);
+				*pBytes += RING_LIBSQL_MEMORY_ITEM_BYTES + b.len + 1;
+			}
+			libsql_free_blob(b);
+		}
+		break;
+	}
+	default:
+		rc = nMemory = ring_libsql_memory_check(pConn, *pBytes + RING_LIBSQL_MEMORY_ITEM_BYTES + 1);
+		if (rc == 0)
+		{
+			ring_list_addstring(pList, "");
+			*pBytes += RING_LIBSQL_MEMORY_ITEM_BYTES + 1;
+		}
+		break;
+	}
+	if (nMemory == RING_LIBSQL_MEMORY_HARD)
+	{
+		*err_msg = pConn->memory.cError;
+	}
+	return rc;
+}
+
+/* Steps the rows handle for every reader (cursor, fetch, fetchRow): retries a locked first step, adds the time
+   to the advisor and harvests the change feed at the end. The caller owns the returned row */
+static int ring_libsql_rows_step(RingLibSQLRows *pRows, libsql_row_t *pRow, const char **err_msg)
+{
+	*pRow = NULL;
+	double nStart = pRows->cAdvisorSQL ? ring_libsql_now_ms() : 0;
+	int rc;
+	if (pRows->lStepped)
+	{
+		rc = libsql_next_row(pRows->rows, pRow, err_msg);
+	}
+	else
+	{
+		/* A query reads lazily, so a locked database usually surfaces at the first step rather than in query() */
+		RingLibSQLBusyCall call;
+		ring_libsql_busy_begin(&call);
+		do
+		{
+			rc = libsql_next_row(pRows->rows, pRow, err_msg);
+		} while (ring_libsql_busy_retry(pRows->pConn, &call, rc, *err_msg));
+		/* query() already counted the statement, the step only adds its contention */
+		if (call.lContended && pRows->pConn->busy.nMaxRetries > 0)
+		{
+			ring_libsql_busy_record(&pRows->pConn->busyMetrics, &call, 0);
+		}
+		pRows->lStepped = 1;
+	}
+	if (pRows->cAdvisorSQL)
+	{
+		pRows->nAdvisorMs += ring_libsql_now_ms() - nStart;
+		if (rc != 0 || !*pRow)
+		{
+			ring_libsql_rows_advise(pRows);
+		}
+	}
+	/* A write run through query() (INSERT ... RETURNING, a COMMIT) has committed once its rows are done */
+	if (rc == 0 && !*pRow && !pRows->lDone)
+	{
+		pRows->lDone = 1;
+		ring_libsql_rows_harvest(pRows);
+	}
+	return rc;
+}
+
+/* Advances the cursor slot, freeing the previous row; *pRow is NULL at the end */
+static int ring_libsql_cursor_step(RingLibSQLRows *pRows, libsql_row_t *pRow, const char **err_msg)
+{
+	if (pRows->row)
+	{
+		libsql_free_row(pRows->row);
+		pRows->row = NULL;
+	}
+	int rc = ring_libsql_rows_step(pRows, pRow, err_msg);
+	if (rc == 0)
+	{
+		pRows->row = *pRow;
+	}
+	return rc;
+}
+
+/* Column names are looked up once per call and kept in the connection arena */
+static const char **ring_libsql_column_names(RingLibSQLRows *pRows, int nCols, const char **err_msg)
+{
+	const char **aNames = (const char **)ring_libsql_arena_alloc(&pRows->pConn->arena, nCols * sizeof(char *));
+	if (!aNames)
+	{
+		*err_msg = "Out of memory";
+		return NULL;
+	}
+	for (int x = 0; x < nCols; x++)
+	{
+		if (libsql_column_name(pRows->rows, x, &aNames[x], err_msg) != 0)
+		{
+			return NULL;
+		}
+	}
+	return aNames;
+}
+
+#define RING_LIBSQL_EXPORT_CSV 1
+#define RING_LIBSQL_EXPORT_JSON 2
+
+static void ring_libsql_buffer_appendcsv(RingLibSQLBuffer *pBuf, const char *cStr, size_t nLen)
+{
+	size_t x;
+	for (x = 0; x < nLen; x++)
+	{
+		if (cStr[x] == ',' || cStr[x] == '"' || cStr[x] == '\n' || cStr[x] == '\r')
+		{
+			break;
+		}
+	}
+	if (x == nLen)
+	{
+		ring_libsql_buffer_append(pBuf, cStr, nLen);
+		return;
+	}
+	ring_libsql_buffer_append(pBuf, "\"", 1);
+	for (x = 0; x < nLen; x++)
+	{
+		if (cStr[x] == '"')
+		{
+			ring_libsql_buffer_append(pBuf, "\"", 1);
+		}
+		ring_libsql_buffer_append(pBuf, cStr + x, 1);
+	}
+	ring_libsql_buffer_append(pBuf, "\"", 1);
+}
+
+static void ring_libsql_buffer_appendjson(RingLibSQLBuffer *pBuf, const char *cStr, size_t nLen)
+{
+	char cEscape[8];
+	size_t nStart = 0;
+	ring_libsql_buffer_append(pBuf, "\"", 1);
+	for (size_t x = 0; x < nLen; x++)
+	{
+		unsigned char c = (unsigned char)cStr[x];
+		if (c != '"' && c != '\\' && c >= 0x20)
+		{
+			continue;
+		}
+		ring_libsql_buffer_append(pBuf, cStr + nStart, x - nStart);
+		if (c == '"' || c == '\\')
+		{
+			cEscape[0] = '\\';
+			cEscape[1] = (char)c;
+			ring_libsql_buffer_append(pBuf, cEscape, 2);
+		}
+		else
+		{
+			snprintf(cEscape, sizeof(cEscape), "\\u%04x", c);
+			ring_libsql_buffer_append(pBuf, cEscape, 6);
+		}
+		nStart = x + 1;
+	}
+	ring_libsql_buffer_append(pBuf, cStr + nStart, nLen - nStart);
+	ring_libsql_buffer_append(pBuf, "\"", 1);
+}
+
+static void ring_libsql_buffer_appendhex(RingLibSQLBuffer *pBuf, const char *pData, int nLen)
+{
+	static const char cDigits[] = "0123456789abcdef";
+	char cByte[2];
+	for (int x = 0; x < nLen; x++)
+	{
+		cByte[0] = cDigits[((unsigned char)pData[x]) >> 4];
+		cByte[1] = cDigits[((unsigned char)pData[x]) & 0x0f];
+		ring_libsql_buffer_append(pBuf, cByte, 2);
+	}
+}
+
+static int ring_libsql_buffer_addvalue(RingLibSQLBuffer *pBuf, int nFormat, libsql_rows_t rows, libsql_row_t row,
+									   int col, const char **err_msg)
+{
+	int type;
+	char cNumber[32];
+	int rc = libsql_column_type(rows, row, col, &type, err_msg);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	switch (type)
+	{
+	case LIBSQL_INT: {
+		long long value;
+		rc = libsql_get_int(row, col, &value, err_msg);
+		if (rc == 0)
+		{
+			snprintf(cNumber, sizeof(cNumber), "%lld", value);
+			ring_libsql_buffer_appendstr(pBuf, cNumber);
+		}
+		break;
+	}
+	case LIBSQL_FLOAT: {
+		double value;
+		rc = libsql_get_float(row, col, &value, err_msg);
+		if (rc == 0)
+		{
+			snprintf(cNumber, sizeof(cNumber), "%.17g", value);
+			ring_libsql_buffer_appendstr(pBuf, cNumber);
+		}
+		break;
+	}
+	case LIBSQL_TEXT: {
+		const char *value;
+		rc = libsql_get_string(row, col, &value, err_msg);
+		if (rc == 0)
+		{
+			if (nFormat == RING_LIBSQL_EXPORT_JSON)
+			{
+				ring_libsql_buffer_appendjson(pBuf, value, strlen(value));
+			}
+			else
+			{
+				ring_libsql_buffer_appendcsv(pBuf, value, strlen(value));
+			}
+			libsql_free_string(value);
+		}
+		break;
+	}
+	case LIBSQL_BLOB: {
+		blob b;
+		rc = libsql_get_blob(row, col, &b, err_msg);
+		if (rc == 0)
+		{
+			/* Blobs are exported as hex strings */
+			if (nFormat == RING_LIBSQL_EXPORT_JSON)
+			{
+				ring_libsql_buffer_append(pBuf, "\"", 1);
+			}
+			ring_libsql_buffer_appendhex(pBuf, b.ptr, b.len);
+			if (nFormat == RING_LIBSQL_EXPORT_JSON)
+			{
+				ring_libsql_buffer_append(pBuf, "\"", 1);
+			}
+			libsql_free_blob(b);
+		}
+		break;
+	}
+	default:
+		if (nFormat == RING_LIBSQL_EXPORT_JSON)
+		{
+			ring_libsql_buffer_append(pBuf, "null", 4);
+		}
+		break;
+	}
+	return rc;
+}
+
+/* Writes the remaining rows as CSV or a JSON array of objects into pBuf, stopping early at the soft memory limit */
+static int ring_libsql_export_rows(RingLibSQLRows *pRows, int nFormat, int lHeader, RingLibSQLBuffer *pBuf,
+								   const char **err_msg)
+{
+	libsql_row_t row;
+	int nCols = libsql_column_count(pRows->rows);
+	int nRow = 0;
+	const char **aNames = ring_libsql_column_names(pRows, nCols, err_msg);
+	if (!aNames)
+	{
+		return 1;
+	}
+	if (nFormat == RING_LIBSQL_EXPORT_CSV && lHeader)
+	{
+		for (int x = 0; x < nCols; x++)
+		{
+			if (x > 0)
+			{
+				ring_libsql_buffer_append(pBuf, ",", 1);
+			}
+			ring_libsql_buffer_appendcsv(pBuf, aNames[x], strlen(aNames[x]));
+		}
+		ring_libsql_buffer_append(pBuf, "\n", 1);
+	}
+	if (nFormat == RING_LIBSQL_EXPORT_JSON)
+	{
+		ring_libsql_buffer_append(pBuf, "[", 1);
+	}
+	ring_libsql_memory_begin(pRows->pConn);
+	pRows->lMore = 0;
+	/* The rows may use the hard limit and the closing bracket one more byte; the buffer stops short of both
+	   instead of growing past them */
+	if (pRows->pConn->memory.nHardLimit > 0)
+	{
+		pBuf->nLimit = pBuf->nLen + (size_t)pRows->pConn->memory.nHardLimit + 1;
+	}
+	while (1)
+	{
+		size_t nStart = pBuf->nLen;
+		int rc = ring_libsql_cursor_step(pRows, &row, err_msg);
+		if (rc != 0)
+		{
+			return rc;
+		}
+		if (!row)
+		{
+			break;
+		}
+		if (nFormat == RING_LIBSQL_EXPORT_JSON)
+		{
+			ring_libsql_buffer_appendstr(pBuf, nRow > 0 ? ",{" : "{");
+		}
+		for (int x = 0; x < nCols; x++)
+		{
+			if (x > 0)
+			{
+				ring_libsql_buffer_append(pBuf, ",", 1);
+			}
+			if (nFormat == RING_LIBSQL_EXPORT_JSON)
+			{
+				ring_libsql_buffer_appendjson(pBuf, aNames[x], strlen(aNames[x]));
+				ring_libsql_buffer_append(pBuf, ":", 1);
+			}
+			rc = ring_libsql_buffer_addvalue(pBuf, nFormat, pRows->rows, row, x, err_msg);
+			if (rc != 0)
+			{
+				return rc;
+			}
+			if (pBuf->nFailed == RING_LIBSQL_BUFFER_LIMIT)
+			{
+				ring_libsql_memory_reject(pRows->pConn);
+				*err_msg = pRows->pConn->memory.cError;
+				return 1;
+			}
+		}
+		ring_libsql_buffer_append(pBuf, nFormat == RING_LIBSQL_EXPORT_JSON ? "}" : "\n", 1);
+		nRow++;
+		int nMemory = ring_libsql_memory_add(pRows->pConn, (double)(pBuf->nLen - nStart));
+		if (nMemory == RING_LIBSQL_MEMORY_HARD)
+		{
+			*err_msg = pRows->pConn->memory.cError;
+			return 1;
+		}
+		if (nMemory == RING_LIBSQL_MEMORY_SOFT)
+		{
+			ring_libsql_rows_chunk(pRows);
+			break;
+		}
+	}
+	if (nFormat == RING_LIBSQL_EXPORT_JSON)
+	{
+		ring_libsql_buffer_append(pBuf, "]", 1);
+	}
+	if (pBuf->nFailed == RING_LIBSQL_BUFFER_LIMIT)
+	{
+		ring_libsql_memory_reject(pRows->pConn);
+		*err_msg = pRows->pConn->memory.cError;
+		return 1;
+	}
+	if (pBuf->nFailed)
+	{
+		*err_msg = "Out of memory";
+		return 1;
+	}
+	return 0;
+}
+
+/* Returns the current cursor row of the rows handle at parameter 1, or NULL after raising an error */
+static RingLibSQLRows *ring_libsql_get_cursor(void *pPointer)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return NULL;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return NULL;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return NULL;
+	if (!pRows->row)
+	{
+		RING_API_ERROR("No current row: call libsql_rows_next() first");
+		return NULL;
+	}
+	return pRows;
+}
+
+/* Functions */
+
+RING_FUNC(ring_libsql_enable_internal_tracing)
+{
+	RING_API_RETNUMBER(libsql_enable_internal_tracing());
+}
+
+/* Monotonic wall-clock milliseconds, for timing code that waits on I/O or sleeps */
+RING_FUNC(ring_libsql_clock_ms)
+{
+	RING_API_RETNUMBER(ring_libsql_now_ms());
+}
+
+RING_FUNC(ring_libsql_sync)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	int rc = libsql_sync(pDB->db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_sync2)
+{
+	const char *err_msg;
+	replicated repl;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	int rc = libsql_sync2(pDB->db, &repl, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	List *pList = RING_API_NEWLIST;
+	ring_list_adddouble(pList, repl.frame_no);
+	ring_list_adddouble(pList, repl.frames_synced);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_libsql_open_sync)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 5)
+	{
+		RING_API_ERROR("Expected 5 parameters: db_path, primary_url, "
+					   "auth_token, read_your_writes, encryption_key");
+		return;
+	}
+	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3) || !RING_API_ISNUMBER(4) ||
+		!RING_API_ISSTRING(5))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_sync(RING_API_GETSTRING(1), RING_API_GETSTRING(2), RING_API_GETSTRING(3),
+							  (char)RING_API_GETNUMBER(4), RING_API_GETSTRING(5), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_open_sync_with_webpki)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 5)
+	{
+		RING_API_ERROR("Expected 5 parameters: db_path, primary_url, "
+					   "auth_token, read_your_writes, encryption_key");
+		return;
+	}
+	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3) || !RING_API_ISNUMBER(4) ||
+		!RING_API_ISSTRING(5))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_sync_with_webpki(RING_API_GETSTRING(1), RING_API_GETSTRING(2), RING_API_GETSTRING(3),
+										  (char)RING_API_GETNUMBER(4), RING_API_GETSTRING(5), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_open_sync_with_config)
+{
+	if (RING_API_PARACOUNT != 1 || !RING_API_ISLIST(1))
+	{
+		RING_API_ERROR("Expected one parameter: a list representing the config.");
+		return;
+	}
+	List *pList = RING_API_GETLIST(1);
+	libsql_config config = {0};
+	RingLibSQLProfile profile;
+	const char *err_msg;
+	libsql_database_t db;
+	if (!ring_libsql_profile_from_list(&profile, pList, &err_msg))
+	{
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	for (int i = 1; i <= ring_list_getsize(pList); i++)
+	{
+		if (!ring_list_islist(pList, i))
+			continue;
+		List *pItem = ring_list_getlist(pList, i);
+		if (ring_list_getsize(pItem) != 2 || !ring_list_isstring(pItem, 1))
+			continue;
+		char *key = ring_string_lower(ring_list_getstring(pItem, 1));
+		if (strcmp(key, "db_path") == 0 && ring_list_isstring(pItem, 2))
+		{
+			config.db_path = ring_list_getstring(pItem, 2);
+		}
+		else if (strcmp(key, "primary_url") == 0 && ring_list_isstring(pItem, 2))
+		{
+			config.primary_url = ring_list_getstring(pItem, 2);
+		}
+		else if (strcmp(key, "auth_token") == 0 && ring_list_isstring(pItem, 2))
+		{
+			config.auth_token = ring_list_getstring(pItem, 2);
+		}
+		else if (strcmp(key, "read_your_writes") == 0 && ring_list_isnumber(pItem, 2))
+		{
+			config.read_your_writes = (char)ring_list_getdouble(pItem, 2);
+		}
+		else if (strcmp(key, "encryption_key") == 0 && ring_list_isstring(pItem, 2))
+		{
+			config.encryption_key = ring_list_getstring(pItem, 2);
+		}
+		else if (strcmp(key, "sync_interval") == 0 && ring_list_isnumber(pItem, 2))
+		{
+			config.sync_interval = (int)ring_list_getdouble(pItem, 2);
+		}
+		else if (strcmp(key, "with_webpki") == 0 && ring_list_isnumber(pItem, 2))
+		{
+			config.with_webpki = (char)ring_list_getdouble(pItem, 2);
+		}
+		else if (strcmp(key, "offline") == 0 && ring_list_isnumber(pItem, 2))
+		{
+			config.offline = (char)ring_list_getdouble(pItem, 2);
+		}
+		else if (strcmp(key, "remote_encryption_key") == 0 && ring_list_isstring(pItem, 2))
+		{
+			config.remote_encryption_key = ring_list_getstring(pItem, 2);
+		}
+	}
+	int rc = libsql_open_sync_with_config(config, &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, &profile);
+}
+
+RING_FUNC(ring_libsql_open_with_config)
+{
+	if (RING_API_PARACOUNT != 1 || !RING_API_ISLIST(1))
+	{
+		RING_API_ERROR("Expected one parameter: a list representing the config.");
+		return;
+	}
+	List *pList = RING_API_GETLIST(1);
+	RingLibSQLProfile profile;
+	const char *db_path = NULL;
+	const char *err_msg;
+	libsql_database_t db;
+	if (!ring_libsql_profile_from_list(&profile, pList, &err_msg))
+	{
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	for (int i = 1; i <= ring_list_getsize(pList); i++)
+	{
+		if (!ring_list_islist(pList, i))
+			continue;
+		List *pItem = ring_list_getlist(pList, i);
+		if (ring_list_getsize(pItem) != 2 || !ring_list_isstring(pItem, 1))
+			continue;
+		if (strcmp(ring_list_getstring(pItem, 1), "db_path") == 0 && ring_list_isstring(pItem, 2))
+		{
+			db_path = ring_list_getstring(pItem, 2);
+		}
+	}
+	if (!db_path)
+	{
+		RING_API_ERROR("Missing config key: db_path");
+		return;
+	}
+	int rc = libsql_open_file(db_path, &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, &profile);
+}
+
+RING_FUNC(ring_libsql_open_ext)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_ext(RING_API_GETSTRING(1), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_open_file)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_file(RING_API_GETSTRING(1), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_open_remote)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_remote(RING_API_GETSTRING(1), RING_API_GETSTRING(2), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_open_remote_with_remote_encryption)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_remote_with_remote_encryption(RING_API_GETSTRING(1), RING_API_GETSTRING(2),
+													   RING_API_GETSTRING(3), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_open_remote_with_webpki)
+{
+	const char *err_msg;
+	libsql_database_t db;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int rc = libsql_open_remote_with_webpki(RING_API_GETSTRING(1), RING_API_GETSTRING(2), &db, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_ret_db(pPointer, db, NULL);
+}
+
+RING_FUNC(ring_libsql_close)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (RING_API_ISPOINTER(1))
+	{
+		RingLibSQLDB *pDB = (RingLibSQLDB *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_DB);
+		if (pDB)
+		{
+			ring_libsql_free_db(NULL, pDB);
+			RING_API_SETNULLPOINTER(1);
+		}
+	}
+	else
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+	}
+}
+
+RING_FUNC(ring_libsql_connect)
+{
+	const char *err_msg;
+	libsql_connection_t conn;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	int rc = libsql_connect(pDB->db, &conn, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	rc = ring_libsql_profile_apply(&pDB->profile, conn, &err_msg);
+	if (rc != 0)
+	{
+		libsql_disconnect(conn);
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	RingLibSQLConn *pConn = (RingLibSQLConn *)calloc(1, sizeof(RingLibSQLConn));
+	if (!pConn)
+	{
+		libsql_disconnect(conn);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	pConn->conn = conn;
+	pConn->nRefs = 1;
+	pConn->busy.nSeed = (unsigned int)((size_t)pConn ^ (size_t)ring_libsql_now_ms()) | 1u;
+	RING_API_RETMANAGEDCPOINTER(pConn, RING_POINTER_LIBSQL_CONN, ring_libsql_free_conn);
+}
+
+RING_FUNC(ring_libsql_load_extension)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	int rc = libsql_load_extension(pConn->conn, RING_API_GETSTRING(2), RING_API_GETSTRING(3), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_set_reserved_bytes)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	int rc = libsql_set_reserved_bytes(pConn->conn, (int32_t)RING_API_GETNUMBER(2), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_get_reserved_bytes)
+{
+	const char *err_msg;
+	int32_t reserved_bytes;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	int rc = libsql_get_reserved_bytes(pConn->conn, &reserved_bytes, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETNUMBER(reserved_bytes);
+}
+
+RING_FUNC(ring_libsql_reset)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	int rc = libsql_reset(pConn->conn, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_disconnect)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (RING_API_ISPOINTER(1))
+	{
+		RingLibSQLConn *pConn = (RingLibSQLConn *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
+		if (pConn)
+		{
+			ring_libsql_free_conn(NULL, pConn);
+			RING_API_SETNULLPOINTER(1);
+		}
+	}
+	else
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+	}
+}
+
+RING_FUNC(ring_libsql_prepare)
+{
+	const char *err_msg;
+	libsql_stmt_t stmt;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLBusyCall call;
+	int rc;
+	ring_libsql_busy_begin(&call);
+	do
+	{
+		rc = libsql_prepare(pConn->conn, RING_API_GETSTRING(2), &stmt, &err_msg);
+	} while (ring_libsql_busy_retry(pConn, &call, rc, err_msg));
+	ring_libsql_busy_end(pConn, &call, NULL);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RingLibSQLStmt *pStmt = (RingLibSQLStmt *)calloc(1, sizeof(RingLibSQLStmt));
+	if (!pStmt)
+	{
+		libsql_free_stmt(stmt);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	pStmt->stmt = stmt;
+	pStmt->pConn = ring_libsql_conn_retain(pConn);
+	pStmt->cSQL = ring_libsql_strdup(RING_API_GETSTRING(2));
+	RING_API_RETMANAGEDCPOINTER(pStmt, RING_POINTER_LIBSQL_STMT, ring_libsql_free_stmt);
+}
+
+RING_FUNC(ring_libsql_bind_int)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_int(pStmt->stmt, (int)RING_API_GETNUMBER(2), (long long)RING_API_GETNUMBER(3), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+/* Binds an exact 64-bit integer given as a decimal string (or a number, like bind_int) */
+RING_FUNC(ring_libsql_bind_int64)
+{
+	const char *err_msg;
+	long long value;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !(RING_API_ISSTRING(3) || RING_API_ISNUMBER(3)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (RING_API_ISNUMBER(3))
+	{
+		value = (long long)RING_API_GETNUMBER(3);
+	}
+	else if (!ring_libsql_int64_parse(RING_API_GETSTRING(3), &value))
+	{
+		RING_API_ERROR("Invalid 64-bit integer string");
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_int(pStmt->stmt, (int)RING_API_GETNUMBER(2), value, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+/* Binds an exact 64-bit integer given as a packed little-endian 8-byte string */
+RING_FUNC(ring_libsql_bind_int64_packed)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (RING_API_GETSTRINGSIZE(3) != 8)
+	{
+		RING_API_ERROR("A packed 64-bit integer must be exactly 8 bytes");
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_int(pStmt->stmt, (int)RING_API_GETNUMBER(2), ring_libsql_int64_read(RING_API_GETSTRING(3)),
+							 &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_bind_float)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_float(pStmt->stmt, (int)RING_API_GETNUMBER(2), RING_API_GETNUMBER(3), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_bind_null)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_null(pStmt->stmt, (int)RING_API_GETNUMBER(2), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_bind_string)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_string(pStmt->stmt, (int)RING_API_GETNUMBER(2), RING_API_GETSTRING(3), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_bind_blob)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_bind_blob(pStmt->stmt, (int)RING_API_GETNUMBER(2), (const unsigned char *)RING_API_GETSTRING(3),
+							  RING_API_GETSTRINGSIZE(3), &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_query_stmt)
+{
+	const char *err_msg;
+	libsql_rows_t rows;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	RingLibSQLBusyCall call;
+	int rc;
+	ring_libsql_arena_reset(&pStmt->pConn->arena);
+	if (pStmt->pConn->pFeed)
+	{
+		pStmt->pConn->pFeed->lSavedChanges = 0;
+	}
+	double nStart = pStmt->pConn->pAdvisor ? ring_libsql_now_ms() : 0;
+	ring_libsql_busy_begin(&call);
+	do
+	{
+		rc = libsql_query_stmt(pStmt->stmt, &rows, &err_msg);
+	} while (ring_libsql_busy_retry(pStmt->pConn, &call, rc, err_msg));
+	ring_libsql_busy_end(pStmt->pConn, &call, &pStmt->busyMetrics);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_txn_track(pStmt->pConn, pStmt->cSQL);
+	ring_libsql_ret_rows(pPointer, pStmt->pConn, rows, pStmt->cSQL, nStart);
+}
+
+RING_FUNC(ring_libsql_execute_stmt)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	RingLibSQLBusyCall call;
+	int rc;
+	ring_libsql_arena_reset(&pStmt->pConn->arena);
+	double nStart = pStmt->pConn->pAdvisor ? ring_libsql_now_ms() : 0;
+	ring_libsql_busy_begin(&call);
+	do
+	{
+		rc = libsql_execute_stmt(pStmt->stmt, &err_msg);
+	} while (ring_libsql_busy_retry(pStmt->pConn, &call, rc, err_msg));
+	ring_libsql_busy_end(pStmt->pConn, &call, &pStmt->busyMetrics);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_txn_track(pStmt->pConn, pStmt->cSQL);
+	if (pStmt->pConn->pAdvisor)
+	{
+		ring_libsql_advisor_record(pStmt->pConn, pStmt->cSQL, ring_libsql_now_ms() - nStart, 1);
+	}
+	ring_libsql_changes_mark(pStmt->pConn, pStmt->cSQL);
+	ring_libsql_changes_harvest(pStmt->pConn);
+}
+
+RING_FUNC(ring_libsql_reset_stmt)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc = libsql_reset_stmt(pStmt->stmt, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+RING_FUNC(ring_libsql_query)
+{
+	const char *err_msg;
+	libsql_rows_t rows;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLBusyCall call;
+	int rc;
+	ring_libsql_arena_reset(&pConn->arena);
+	if (pConn->pFeed)
+	{
+		pConn->pFeed->lSavedChanges = 0;
+	}
+	double nStart = pConn->pAdvisor ? ring_libsql_now_ms() : 0;
+	ring_libsql_busy_begin(&call);
+	do
+	{
+		rc = libsql_query(pConn->conn, RING_API_GETSTRING(2), &rows, &err_msg);
+	} while (ring_libsql_busy_retry(pConn, &call, rc, err_msg));
+	ring_libsql_busy_end(pConn, &call, NULL);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_txn_track(pConn, RING_API_GETSTRING(2));
+	ring_libsql_ret_rows(pPointer, pConn, rows, RING_API_GETSTRING(2), nStart);
+}
+
+RING_FUNC(ring_libsql_execute)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLBusyCall call;
+	int rc;
+	ring_libsql_arena_reset(&pConn->arena);
+	double nStart = pConn->pAdvisor ? ring_libsql_now_ms() : 0;
+	ring_libsql_busy_begin(&call);
+	do
+	{
+		rc = libsql_execute(pConn->conn, RING_API_GETSTRING(2), &err_msg);
+	} while (ring_libsql_busy_retry(pConn, &call, rc, err_msg));
+	ring_libsql_busy_end(pConn, &call, NULL);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_txn_track(pConn, RING_API_GETSTRING(2));
+	if (pConn->pAdvisor)
+	{
+		ring_libsql_advisor_record(pConn, RING_API_GETSTRING(2), ring_libsql_now_ms() - nStart, 1);
+	}
+	ring_libsql_changes_mark(pConn, RING_API_GETSTRING(2));
+	ring_libsql_changes_harvest(pConn);
+}
+
+RING_FUNC(ring_libsql_wait_result)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	libsql_rows_future_t future = (libsql_rows_future_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROWS_FUTURE);
+	libsql_wait_result(future);
+}
+
+RING_FUNC(ring_libsql_column_count)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	RING_API_RETNUMBER(libsql_column_count(pRows->rows));
+}
+
+RING_FUNC(ring_libsql_column_name)
+{
+	const char *name;
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	int rc = libsql_column_name(pRows->rows, (int)RING_API_GETNUMBER(2), &name, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETSTRING(name);
+}
+
+RING_FUNC(ring_libsql_column_type)
+{
+	int type;
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISPOINTER(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	RingLibSQLRow *pRow = ring_libsql_get_row(pPointer, 2);
+	if (!pRow)
+		return;
+	int rc = libsql_column_type(pRows->rows, pRow->row, (int)RING_API_GETNUMBER(3), &type, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETNUMBER(type);
+}
+
+RING_FUNC(ring_libsql_changes)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	if (pConn->pFeed && pConn->pFeed->lSavedChanges)
+	{
+		RING_API_RETNUMBER(pConn->pFeed->nSavedChanges);
+		return;
+	}
+	RING_API_RETNUMBER(libsql_changes(pConn->conn));
+}
+
+RING_FUNC(ring_libsql_last_insert_rowid)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RING_API_RETNUMBER(libsql_last_insert_rowid(pConn->conn));
+}
+
+RING_FUNC(ring_libsql_next_row)
+{
+	const char *err_msg;
+	libsql_row_t row;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	int rc = ring_libsql_rows_step(pRows, &row, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	if (row)
+	{
+		RingLibSQLRow *pRow = (RingLibSQLRow *)malloc(sizeof(RingLibSQLRow));
+		if (!pRow)
+		{
+			libsql_free_row(row);
+			RING_API_ERROR("Out of memory");
+			return;
+		}
+		pRow->row = row;
+		pRow->nInt64Mode = pRows->nInt64Mode;
+		RING_API_RETMANAGEDCPOINTER(pRow, RING_POINTER_LIBSQL_ROW, ring_libsql_free_row);
+	}
+}
+
+/* Cursor: advances the reusable row slot of the rows handle in place */
+
+RING_FUNC(ring_libsql_rows_next)
+{
+	const char *err_msg;
+	libsql_row_t row = NULL;
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	int rc = ring_libsql_cursor_step(pRows, &row, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETNUMBER(row != NULL);
+}
+
+RING_FUNC(ring_libsql_rows_get_type)
+{
+	int type;
+	const char *err_msg;
+	RingLibSQLRows *pRows = ring_libsql_get_cursor(pPointer);
+	if (!pRows)
+		return;
+	int rc = libsql_column_type(pRows->rows, pRows->row, (int)RING_API_GETNUMBER(2), &type, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETNUMBER(type);
+}
+
+RING_FUNC(ring_libsql_rows_get_string)
+{
+	const char *value;
+	const char *err_msg;
+	RingLibSQLRows *pRows = ring_libsql_get_cursor(pPointer);
+	if (!pRows)
+		return;
+	int rc = libsql_get_string(pRows->row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_memory_begin(pRows->pConn);
+	if (ring_libsql_memory_add(pRows->pConn, RING_LIBSQL_MEMORY_ITEM_BYTES + strlen(value) + 1) ==
+		RING_LIBSQL_MEMORY_HARD)
+	{
+		libsql_free_string(value);
+		RING_API_ERROR(pRows->pConn->memory.cError);
+		return;
+	}
+	RING_API_RETSTRING(value);
+	libsql_free_string(value);
+}
+
+RING_FUNC(ring_libsql_rows_get_int)
+{
+	long long value;
+	const char *err_msg;
+	RingLibSQLRows *pRows = ring_libsql_get_cursor(pPointer);
+	if (!pRows)
+		return;
+	int rc = libsql_get_int(pRows->row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	if (pRows->nInt64Mode != RING_LIBSQL_INT64_NUMBER)
+	{
+		char cValue[21];
+		int nLen = ring_libsql_int64_format(value, pRows->nInt64Mode, cValue);
+		RING_API_RETSTRING2(cValue, nLen);
+		return;
+	}
+	RING_API_RETNUMBER(value);
+}
+
+RING_FUNC(ring_libsql_rows_get_float)
+{
+	double value;
+	const char *err_msg;
+	RingLibSQLRows *pRows = ring_libsql_get_cursor(pPointer);
+	if (!pRows)
+		return;
+	int rc = libsql_get_float(pRows->row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETNUMBER(value);
+}
+
+RING_FUNC(ring_libsql_rows_get_blob)
+{
+	blob b;
+	const char *err_msg;
+	RingLibSQLRows *pRows = ring_libsql_get_cursor(pPointer);
+	if (!pRows)
+		return;
+	int rc = libsql_get_blob(pRows->row, (int)RING_API_GETNUMBER(2), &b, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	ring_libsql_memory_begin(pRows->pConn);
+	if (ring_libsql_memory_add(pRows->pConn, RING_LIBSQL_MEMORY_ITEM_BYTES + b.len + 1) == RING_LIBSQL_MEMORY_HARD)
+	{
+		libsql_free_blob(b);
+		RING_API_ERROR(pRows->pConn->memory.cError);
+		return;
+	}
+	RING_API_RETSTRING2(b.ptr, b.len);
+	libsql_free_blob(b);
+}
+
+RING_FUNC(ring_libsql_rows_get_value)
+{
+	RingLibSQLRows *pRows = ring_libsql_get_cursor(pPointer);
+	if (!pRows)
+		return;
+	ring_libsql_ret_value(pPointer, pRows->pConn, pRows->rows, pRows->row, (int)RING_API_GETNUMBER(2),
+						  pRows->nInt64Mode);
+}
+
+/* Int64 Transport Functions */
+
+RING_FUNC(ring_libsql_rows_set_int64_mode)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int nMode = (int)RING_API_GETNUMBER(2);
+	if (nMode != RING_LIBSQL_INT64_NUMBER && nMode != RING_LIBSQL_INT64_DECIMAL && nMode != RING_LIBSQL_INT64_PACKED)
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	pRows->nInt64Mode = nMode;
+}
+
+/* Converts a decimal string to the packed 8-byte form */
+RING_FUNC(ring_libsql_int64_pack)
+{
+	long long value;
+	char cValue[21];
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (!ring_libsql_int64_parse(RING_API_GETSTRING(1), &value))
+	{
+		RING_API_ERROR("Invalid 64-bit integer string");
+		return;
+	}
+	RING_API_RETSTRING2(cValue, ring_libsql_int64_format(value, RING_LIBSQL_INT64_PACKED, cValue));
+}
+
+/* Converts a packed 8-byte string back to its decimal form */
+RING_FUNC(ring_libsql_int64_unpack)
+{
+	char cValue[21];
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (RING_API_GETSTRINGSIZE(1) != 8)
+	{
+		RING_API_ERROR("A packed 64-bit integer must be exactly 8 bytes");
+		return;
+	}
+	long long value = ring_libsql_int64_read(RING_API_GETSTRING(1));
+	RING_API_RETSTRING2(cValue, ring_libsql_int64_format(value, RING_LIBSQL_INT64_DECIMAL, cValue));
+}
+
+/* Vector Functions */
+
+RING_FUNC(ring_libsql_bind_vector)
+{
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !(RING_API_ISLIST(3) || RING_API_ISSTRING(3)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	int rc;
+	if (RING_API_ISLIST(3))
+	{
+		rc = ring_libsql_stmt_bind_vector(pStmt->stmt, &pStmt->pConn->arena, (int)RING_API_GETNUMBER(2),
+										  RING_API_GETLIST(3), NULL, 0, &err_msg);
+	}
+	else
+	{
+		rc = ring_libsql_stmt_bind_vector(pStmt->stmt, &pStmt->pConn->arena, (int)RING_API_GETNUMBER(2), NULL,
+										  RING_API_GETSTRING(3), RING_API_GETSTRINGSIZE(3), &err_msg);
+	}
+	LIBSQL_CHECK_OK(rc, err_msg);
+}
+
+/* Runs one of the batch's own transaction statements with the connection's busy strategy */
+static int ring_libsql_batch_exec(RingLibSQLConn *pConn, const char *cSQL, const char **err_msg)
+{
+	RingLibSQLBusyCall call;
+	int rc;
+	ring_libsql_busy_begin(&call);
+	do
+	{
+		rc = libsql_execute(pConn->conn, cSQL, err_msg);
+	} while (ring_libsql_busy_retry(pConn, &call, rc, *err_msg));
+	ring_libsql_busy_end(pConn, &call, NULL);
+	return rc;
+}
+
+/* Executes a two-parameter statement (id, vector) once per item; returns the number of rows written. The rows
+   are written in one transaction, or in a savepoint when the caller already has one open, and a failing row
+   rolls the whole batch back. nIDMode tells how string ids are bound: as text (NUMBER, the default), or as
+   exact integers given as decimal (DECIMAL) or packed 8-byte (PACKED) strings */
+RING_FUNC(ring_libsql_vector_batch)
+{
+	const char *err_msg = NULL;
+	int nIDMode = RING_LIBSQL_INT64_NUMBER;
+	if (RING_API_PARACOUNT != 3 && RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISLIST(2) || !RING_API_ISLIST(3) ||
+		(RING_API_PARACOUNT == 4 && !RING_API_ISNUMBER(4)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (RING_API_PARACOUNT == 4)
+	{
+		nIDMode = (int)RING_API_GETNUMBER(4);
+		if (nIDMode != RING_LIBSQL_INT64_NUMBER && nIDMode != RING_LIBSQL_INT64_DECIMAL &&
+			nIDMode != RING_LIBSQL_INT64_PACKED)
+		{
+			RING_API_ERROR(RING_API_BADPARAVALUE);
+			return;
+		}
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	RingLibSQLConn *pConn = pStmt->pConn;
+	List *pIDs = RING_API_GETLIST(2);
+	List *pVectors = RING_API_GETLIST(3);
+	int nCount = ring_list_getsize(pIDs);
+	if (ring_list_getsize(pVectors) != nCount)
+	{
+		RING_API_ERROR("The id and vector lists must have the same length");
+		return;
+	}
+	/* BEGIN IMMEDIATE takes the write lock up front, so only that statement can meet a busy writer */
+	int lSavepoint = ring_libsql_in_transaction(pConn);
+	int rc = ring_libsql_batch_exec(pConn, lSavepoint ? "SAVEPOINT ring_libsql_batch" : "BEGIN IMMEDIATE", &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	double nChanges = 0;
+	for (int x = 1; x <= nCount && rc == 0; x++)
+	{
+		long long nID;
+		ring_libsql_arena_reset(&pConn->arena);
+		rc = libsql_reset_stmt(pStmt->stmt, &err_msg);
+		if (rc == 0 && ring_list_isnumber(pIDs, x))
+		{
+			rc = libsql_bind_int(pStmt->stmt, 1, (long long)ring_list_getdouble(pIDs, x), &err_msg);
+		}
+		else if (rc == 0 && ring_list_isstring(pIDs, x) && nIDMode == RING_LIBSQL_INT64_DECIMAL)
+		{
+			if (ring_libsql_int64_parse(ring_list_getstring(pIDs, x), &nID))
+			{
+				rc = libsql_bind_int(pStmt->stmt, 1, nID, &err_msg);
+			}
+			else
+			{
+				err_msg = "Invalid 64-bit integer string";
+				rc = 1;
+			}
+		}
+		else if (rc == 0 && ring_list_isstring(pIDs, x) && nIDMode == RING_LIBSQL_INT64_PACKED)
+		{
+			if (ring_list_getstringsize(pIDs, x) == 8)
+			{
+				rc = libsql_bind_int(pStmt->stmt, 1, ring_libsql_int64_read(ring_list_getstring(pIDs, x)), &err_msg);
+			}
+			else
+			{
+				err_msg = "A packed 64-bit integer must be exactly 8 bytes";
+				rc = 1;
+			}
+		}
+		else if (rc == 0 && ring_list_isstring(pIDs, x))
+		{
+			rc = libsql_bind_string(pStmt->stmt, 1, ring_list_getstring(pIDs, x), &err_msg);
+		}
+		else if (rc == 0)
+		{
+			rc = libsql_bind_null(pStmt->stmt, 1, &err_msg);
+		}
+		if (rc == 0 && ring_list_islist(pVectors, x))
+		{
+			rc = ring_libsql_stmt_bind_vector(pStmt->stmt, &pConn->arena, 2, ring_list_getlist(pVectors, x), NULL, 0,
+											  &err_msg);
+		}
+		else if (rc == 0 && ring_list_isstring(pVectors, x))
+		{
+			rc = ring_libsql_stmt_bind_vector(pStmt->stmt, &pConn->arena, 2, NULL, ring_list_getstring(pVectors, x),
+											  ring_list_getstringsize(pVectors, x), &err_msg);
+		}
+		else if (rc == 0)
+		{
+			err_msg = "A vector must be a list of numbers or a packed float32 string";
+			rc = 1;
+		}
+		if (rc == 0)
+		{
+			rc = libsql_execute_stmt(pStmt->stmt, &err_msg);
+		}
+		if (rc == 0)
+		{
+			nChanges += (double)libsql_changes(pConn->conn);
+		}
+	}
+	if (rc == 0)
+	{
+		rc = ring_libsql_batch_exec(pConn, lSavepoint ? "RELEASE ring_libsql_batch" : "COMMIT", &err_msg);
+	}
+	if (rc != 0)
+	{
+		const char *undo_msg;
+		if (lSavepoint)
+		{
+			libsql_execute(pConn->conn, "ROLLBACK TO ring_libsql_batch", &undo_msg);
+			libsql_execute(pConn->conn, "RELEASE ring_libsql_batch", &undo_msg);
+		}
+		else
+		{
+			libsql_execute(pConn->conn, "ROLLBACK", &undo_msg);
+		}
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	if (pConn->pFeed && nChanges > 0)
+	{
+		pConn->pFeed->lDirty = 1;
+	}
+	ring_libsql_changes_harvest(pConn);
+	RING_API_RETNUMBER(nChanges);
+}
+
+/* Maps a metric name as written in libsql_vector_idx options ("cosine", "l2") to its distance function */
+static const char *ring_libsql_vector_metric_func(const char *cMetric, size_t nLen)
+{
+	if ((nLen == 3 || nLen == 6) && ring_libsql_equals_nocase_n(cMetric, "cosine", nLen))
+	{
+		return "vector_distance_cos";
+	}
+	if (nLen == 2 && ring_libsql_equals_nocase_n(cMetric, "l2", nLen))
+	{
+		return "vector_distance_l2";
+	}
+	return NULL;
+}
+
+/* Reads the metric=... option from the index definition; indexes without one use cosine distance */
+static int ring_libsql_vector_index_metric(libsql_connection_t conn, const char *cIndex, const char **pFunc,
+										   const char **err_msg)
+{
+	char *cDefinition;
+	int rc = ring_libsql_query_text(
+		conn, ring_libsql_sprintf("SELECT sql FROM sqlite_master WHERE type = 'index' AND name = %s", cIndex),
+		&cDefinition, err_msg);
+	if (rc != 0)
+	{
+		return rc;
+	}
+	if (!cDefinition)
+	{
+		*err_msg = "Vector index not found";
+		return 1;
+	}
+	*pFunc = "vector_distance_cos";
+	for (char *p = cDefinition; *p; p++)
+	{
+		if (!ring_libsql_equals_nocase_n(p, "metric", 6))
+		{
+			continue;
+		}
+		char *cValue = p + 6;
+		while (*cValue == ' ')
+			cValue++;
+		if (*cValue != '=')
+		{
+			continue;
+		}
+		cValue++;
+		while (*cValue == ' ')
+			cValue++;
+		size_t nLen = 0;
+		while (isalnum((unsigned char)cValue[nLen]))
+			nLen++;
+		*pFunc = ring_libsql_vector_metric_func(cValue, nLen);
+		if (!*pFunc)
+		{
+			*err_msg = "Unsupported vector index metric";
+			rc = 1;
+		}
+		break;
+	}
+	free(cDefinition);
+	return rc;
+}
+
+/* Nearest neighbours: uses vector_top_k when an index is given, a full scan otherwise. The distance metric is the
+   one the index was built with unless a metric is passed; full scans default to cosine distance.
+   Returns [ids, distances]: ids as packed int64 values, distances as packed float32 values */
+RING_FUNC(ring_libsql_vector_top_k)
+{
+	const char *err_msg = NULL;
+	libsql_stmt_t stmt = NULL;
+	libsql_rows_t rows = NULL;
+	libsql_row_t row = NULL;
+	if (RING_API_PARACOUNT != 6 && RING_API_PARACOUNT != 7)
+	{
+		RING_API_ERROR("Expected 6 or 7 parameters: conn, table, column, index, query_vector, k [, metric]");
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3) || !RING_API_ISSTRING(4) ||
+		!(RING_API_ISLIST(5) || RING_API_ISSTRING(5)) || !RING_API_ISNUMBER(6) ||
+		(RING_API_PARACOUNT == 7 && !RING_API_ISSTRING(7)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int nK = (int)RING_API_GETNUMBER(6);
+	if (nK < 1)
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	const char *cFunc = NULL;
+	if (RING_API_PARACOUNT == 7 && *RING_API_GETSTRING(7))
+	{
+		cFunc = ring_libsql_vector_metric_func(RING_API_GETSTRING(7), strlen(RING_API_GETSTRING(7)));
+		if (!cFunc)
+		{
+			RING_API_ERROR("metric must be \"cosine\" or \"l2\"");
+			return;
+		}
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	ring_libsql_arena_reset(&pConn->arena);
+	int lIndex = *RING_API_GETSTRING(4) != '\0';
+	char *cTable = ring_libsql_quote(RING_API_GETSTRING(2), '"');
+	char *cColumn = ring_libsql_quote(RING_API_GETSTRING(3), '"');
+	char *cIndex = ring_libsql_quote(RING_API_GETSTRING(4), '\'');
+	char *cSQL = NULL;
+	int rc = 0;
+	if (!cTable || !cColumn || !cIndex)
+	{
+		err_msg = "Out of memory";
+		rc = 1;
+	}
+	else if (!cFunc && lIndex)
+	{
+		rc = ring_libsql_vector_index_metric(pConn->conn, cIndex, &cFunc, &err_msg);
+	}
+	else if (!cFunc)
+	{
+		cFunc = "vector_distance_cos";
+	}
+	if (rc == 0 && lIndex)
+	{
+		cSQL = ring_libsql_sprintf("SELECT t.rowid, %s(t.%s, ?1) FROM vector_top_k(%s, ?1, %d) AS v "
+								   "JOIN %s AS t ON t.rowid = v.id ORDER BY 2",
+								   cFunc, cColumn, cIndex, nK, cTable);
+	}
+	else if (rc == 0)
+	{
+		cSQL = ring_libsql_sprintf("SELECT rowid, %s(%s, ?1) AS d FROM %s ORDER BY d LIMIT %d", cFunc, cColumn,
+								   cTable, nK);
+	}
+	free(cTable);
+	free(cColumn);
+	free(cIndex);
+	if (rc == 0 && !cSQL)
+	{
+		err_msg = "Out of memory";
+		rc = 1;
+	}
+	LIBSQL_CHECK_OK(rc, err_msg);
+	rc = libsql_prepare(pConn->conn, cSQL, &stmt, &err_msg);
+	free(cSQL);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	if (RING_API_ISLIST(5))
+	{
+		rc = ring_libsql_stmt_bind_vector(stmt, &pConn->arena, 1, RING_API_GETLIST(5), NULL, 0, &err_msg);
+	}
+	else
+	{
+		rc = ring_libsql_stmt_bind_vector(stmt, &pConn->arena, 1, NULL, RING_API_GETSTRING(5),
+										  RING_API_GETSTRINGSIZE(5), &err_msg);
+	}
+	if (rc == 0)
+	{
+		rc = libsql_query_stmt(stmt, &rows, &err_msg);
+	}
+	/* k is known up front, so both outputs are sized once in the arena */
+	char *pIDs = (char *)ring_libsql_arena_alloc(&pConn->arena, (size_t)nK * 8);
+	char *pDistances = (char *)ring_libsql_arena_alloc(&pConn->arena, (size_t)nK * 4);
+	int nFound = 0;
+	if (rc == 0 && (!pIDs || !pDistances))
+	{
+		err_msg = "Out of memory";
+		rc = 1;
+	}
+	while (rc == 0 && nFound < nK && (rc = libsql_next_row(rows, &row, &err_msg)) == 0 && row)
+	{
+		long long nID;
+		double nDistance;
+		rc = libsql_get_int(row, 0, &nID, &err_msg);
+		if (rc == 0)
+		{
+			rc = libsql_get_float(row, 1, &nDistance, &err_msg);
+		}
+		if (rc == 0)
+		{
+			ring_libsql_int64_format(nID, RING_LIBSQL_INT64_PACKED, pIDs + nFound * 8);
+			ring_libsql_float32_write(pDistances + nFound * 4, nDistance);
+			nFound++;
+		}
+		libsql_free_row(row);
+		row = NULL;
+	}
+	if (rows)
+	{
+		libsql_free_rows(rows);
+	}
+	libsql_free_stmt(stmt);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	List *pList = RING_API_NEWLIST;
+	ring_list_addstring2(pList, pIDs, nFound * 8);
+	ring_list_addstring2(pList, pDistances, nFound * 4);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_libsql_vector_pack)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISLIST(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	List *pList = RING_API_GETLIST(1);
+	int nLen = ring_list_getsize(pList) * 4;
+	char *pData = (char *)malloc((size_t)nLen + 1);
+	if (!pData)
+	{
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	if (!ring_libsql_vector_write(pData, pList))
+	{
+		free(pData);
+		RING_API_ERROR("A vector must be a list of numbers");
+		return;
+	}
+	RING_API_RETSTRING2(pData, nLen);
+	free(pData);
+}
+
+RING_FUNC(ring_libsql_vector_unpack)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	const char *pData = RING_API_GETSTRING(1);
+	int nLen = RING_API_GETSTRINGSIZE(1);
+	if (nLen % 4 != 0)
+	{
+		RING_API_ERROR("A packed vector must hold a whole number of float32 values");
+		return;
+	}
+	List *pList = RING_API_NEWLIST;
+	for (int x = 0; x < nLen; x += 4)
+	{
+		ring_list_adddouble(pList, ring_libsql_float32_read(pData + x));
+	}
+	RING_API_RETLIST(pList);
+}
+
+/* Unpacks a string of packed int64 values (such as vector_top_k ids) into a list of numbers */
+RING_FUNC(ring_libsql_int64_unpack_list)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	const char *pData = RING_API_GETSTRING(1);
+	int nLen = RING_API_GETSTRINGSIZE(1);
+	if (nLen % 8 != 0)
+	{
+		RING_API_ERROR("Packed 64-bit integers must be a multiple of 8 bytes");
+		return;
+	}
+	List *pList = RING_API_NEWLIST;
+	for (int x = 0; x < nLen; x += 8)
+	{
+		ring_list_adddouble(pList, (double)ring_libsql_int64_read(pData + x));
+	}
+	RING_API_RETLIST(pList);
+}
+
+/* Bulk Fetch and Export */
+
+/* Fetches the rows up to the soft limit. With lContinue set the call continues the previous chunk's memory
+   total, so a caller merging chunks stays under the hard limit as a whole */
+RING_FUNC(ring_libsql_fetch_all)
+{
+	const char *err_msg;
+	libsql_row_t row;
+	if (RING_API_PARACOUNT != 1 && RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || (RING_API_PARACOUNT == 2 && !RING_API_ISNUMBER(2)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	int nCols = libsql_column_count(pRows->rows);
+	List *pList = RING_API_NEWLIST;
+	if (RING_API_PARACOUNT == 2 && RING_API_GETNUMBER(2))
+	{
+		ring_libsql_memory_continue(pRows->pConn);
+	}
+	else
+	{
+		ring_libsql_memory_begin(pRows->pConn);
+	}
+	pRows->lMore = 0;
+	while (1)
+	{
+		int rc = ring_libsql_cursor_step(pRows, &row, &err_msg);
+		LIBSQL_CHECK_OK(rc, err_msg);
+		if (!row)
+		{
+			break;
+		}
+		double nBytes = RING_LIBSQL_MEMORY_ROW_BYTES;
+		if (ring_libsql_memory_check(pRows->pConn, nBytes) == RING_LIBSQL_MEMORY_HARD)
+		{
+			RING_API_ERROR(pRows->pConn->memory.cError);
+			return;
+		}
+		List *pRow = ring_list_newlist(pList);
+		for (int x = 0; x < nCols; x++)
+		{
+			rc = ring_libsql_list_addvalue(pRow, pRows->pConn, pRows->rows, row, x, pRows->nInt64Mode, &nBytes, &err_msg);
+			LIBSQL_CHECK_OK(rc, err_msg);
+		}
+		int nMemory = ring_libsql_memory_add(pRows->pConn, nBytes);
+		if (nMemory == RING_LIBSQL_MEMORY_HARD)
+		{
+			RING_API_ERROR(pRows->pConn->memory.cError);
+			return;
+		}
+		if (nMemory == RING_LIBSQL_MEMORY_SOFT)
+		{
+			ring_libsql_rows_chunk(pRows);
+			break;
+		}
+	}
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_libsql_fetch_all_assoc)
+{
+	const char *err_msg;
+	libsql_row_t row;
+	if (RING_API_PARACOUNT != 1 && RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || (RING_API_PARACOUNT == 2 && !RING_API_ISNUMBER(2)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	int nCols = libsql_column_count(pRows->rows);
+	ring_libsql_arena_reset(&pRows->pConn->arena);
+	const char **aNames = ring_libsql_column_names(pRows, nCols, &err_msg);
+	if (!aNames)
+	{
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	List *pList = RING_API_NEWLIST;
+	if (RING_API_PARACOUNT == 2 && RING_API_GETNUMBER(2))
+	{
+		ring_libsql_memory_continue(pRows->pConn);
+	}
+	else
+	{
+		ring_libsql_memory_begin(pRows->pConn);
+	}
+	pRows->lMore = 0;
+	while (1)
+	{
+		int rc = ring_libsql_cursor_step(pRows, &row, &err_msg);
+		LIBSQL_CHECK_OK(rc, err_msg);
+		if (!row)
+		{
+			break;
+		}
+		double nBytes = RING_LIBSQL_MEMORY_ROW_BYTES;
+		if (ring_libsql_memory_check(pRows->pConn, nBytes) == RING_LIBSQL_MEMORY_HARD)
+		{
+			RING_API_ERROR(pRows->pConn->memory.cError);
+			return;
+		}
+		List *pRow = ring_list_newlist(pList);
+		for (int x = 0; x < nCols; x++)
+		{
+			double nName = RING_LIBSQL_MEMORY_ROW_BYTES + RING_LIBSQL_MEMORY_ITEM_BYTES + strlen(aNames[x]) + 1;
+			if (ring_libsql_memory_check(pRows->pConn, nBytes + nName) == RING_LIBSQL_MEMORY_HARD)
+			{
+				RING_API_ERROR(pRows->pConn->memory.cError);
+				return;
+			}
+			List *pPair = ring_list_newlist(pRow);
+			ring_list_addstring(pPair, aNames[x]);
+			nBytes += nName;
+			rc = ring_libsql_list_addvalue(pPair, pRows->pConn, pRows->rows, row, x, pRows->nInt64Mode, &nBytes, &err_msg);
+			LIBSQL_CHECK_OK(rc, err_msg);
+		}
+		int nMemory = ring_libsql_memory_add(pRows->pConn, nBytes);
+		if (nMemory == RING_LIBSQL_MEMORY_HARD)
+		{
+			RING_API_ERROR(pRows->pConn->memory.cError);
+			return;
+		}
+		if (nMemory == RING_LIBSQL_MEMORY_SOFT)
+		{
+			ring_libsql_rows_chunk(pRows);
+			break;
+		}
+	}
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_libsql_rows_to_csv)
+{
+	const char *err_msg;
+	RingLibSQLBuffer buf = {0};
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	ring_libsql_arena_reset(&pRows->pConn->arena);
+	buf.pArena = &pRows->pConn->arena;
+	int rc = ring_libsql_export_rows(pRows, RING_LIBSQL_EXPORT_CSV, (int)RING_API_GETNUMBER(2), &buf, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETSTRING2(buf.pData ? buf.pData : "", (int)buf.nLen);
+}
+
+RING_FUNC(ring_libsql_rows_to_json)
+{
+	const char *err_msg;
+	RingLibSQLBuffer buf = {0};
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	ring_libsql_arena_reset(&pRows->pConn->arena);
+	buf.pArena = &pRows->pConn->arena;
+	int rc = ring_libsql_export_rows(pRows, RING_LIBSQL_EXPORT_JSON, 0, &buf, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETSTRING2(buf.pData, (int)buf.nLen);
+}
+
+/* True when the last fetch or export stopped at the soft memory limit */
+RING_FUNC(ring_libsql_rows_has_more)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLRows *pRows = ring_libsql_get_rows(pPointer, 1);
+	if (!pRows)
+		return;
+	RING_API_RETNUMBER(pRows->lMore);
+}
+
+/* Statistics */
+
+RING_FUNC(ring_libsql_conn_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	List *pList = RING_API_NEWLIST;
+	ring_libsql_list_addpair(pList, "arena_capacity", (double)pConn->arena.nCapacity);
+	ring_libsql_list_addpair(pList, "arena_used", (double)pConn->arena.nUsed);
+	ring_libsql_list_addpair(pList, "arena_high_water", (double)pConn->arena.nHighWater);
+	ring_libsql_list_addpair(pList, "arena_resets", pConn->arena.nResets);
+	ring_libsql_busy_addmetrics(pList, &pConn->busyMetrics);
+	RingLibSQLChangeFeed feed;
+	memset(&feed, 0, sizeof(feed));
+	if (pConn->pFeed)
+	{
+		feed = *pConn->pFeed;
+	}
+	ring_libsql_list_addpair(pList, "changes_capacity", pConn->pFeed ? (double)feed.nMask + 1 : 0);
+	ring_libsql_list_addpair(pList, "changes_pending", (double)(feed.nTail - feed.nHead));
+	ring_libsql_list_addpair(pList, "changes_captured", feed.nCaptured);
+	ring_libsql_list_addpair(pList, "changes_drained", feed.nDrained);
+	ring_libsql_list_addpair(pList, "changes_overflow", feed.nOverflow);
+	ring_libsql_list_addpair(pList, "changes_harvests", feed.nHarvests);
+	ring_libsql_list_addpair(pList, "changes_harvest_errors", feed.nHarvestErrors);
+	ring_libsql_list_addpair(pList, "memory_current", pConn->memory.nCurrent);
+	ring_libsql_list_addpair(pList, "memory_peak", pConn->memory.nPeak);
+	ring_libsql_list_addpair(pList, "memory_total", pConn->memory.nTotal);
+	ring_libsql_list_addpair(pList, "memory_soft_limit", pConn->memory.nSoftLimit);
+	ring_libsql_list_addpair(pList, "memory_hard_limit", pConn->memory.nHardLimit);
+	ring_libsql_list_addpair(pList, "memory_chunks", pConn->memory.nChunks);
+	ring_libsql_list_addpair(pList, "memory_rejected", pConn->memory.nRejected);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_libsql_stmt_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingLibSQLStmt *pStmt = ring_libsql_get_stmt(pPointer, 1);
+	if (!pStmt)
+		return;
+	List *pList = RING_API_NEWLIST;
+	ring_libsql_busy_addmetrics(pList, &pStmt->busyMetrics);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_libsql_set_busy_strategy)
+{
+	if (RING_API_PARACOUNT != 5)
+	{
+		RING_API_ERROR("Expected 5 parameters: conn, timeout_ms, max_retries, base_delay_ms, max_delay_ms");
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3) || !RING_API_ISNUMBER(4) ||
+		!RING_API_ISNUMBER(5))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (RING_API_GETNUMBER(2) < 0 || RING_API_GETNUMBER(3) < 0 || RING_API_GETNUMBER(4) < 0 ||
+		RING_API_GETNUMBER(5) < RING_API_GETNUMBER(4))
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	pConn->busy.nTimeout = RING_API_GETNUMBER(2);
+	pConn->busy.nMaxRetries = (int)RING_API_GETNUMBER(3);
+	pConn->busy.nBaseDelay = (int)RING_API_GETNUMBER(4);
+	pConn->busy.nMaxDelay = (int)RING_API_GETNUMBER(5);
+}
+
+/* Soft limit: fetches and exports return early and hasMore() reports the rest; hard limit: the call fails */
+RING_FUNC(ring_libsql_set_memory_limits)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	double nSoft = RING_API_GETNUMBER(2);
+	double nHard = RING_API_GETNUMBER(3);
+	if (nSoft < 0 || nHard < 0 || (nSoft > 0 && nHard > 0 && nHard < nSoft))
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	pConn->memory.nSoftLimit = nSoft;
+	pConn->memory.nHardLimit = nHard;
+}
+
+RING_FUNC(ring_libsql_get_string)
+{
+	const char *value;
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	int rc = libsql_open_sync(RING_API_GETSTRING(1), RING_API_GETSTRING(2), RING_API_GETSTRING(3),
-							  (char)RING_API_GETNUMBER(4), RING_API_GETSTRING(5), &db, &err_msg);
+	RingLibSQLRow *pRow = ring_libsql_get_row(pPointer, 1);
+	if (!pRow)
+		return;
+	int rc = libsql_get_string(pRow->row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	RING_API_RETSTRING(value);
+	libsql_free_string(value);
 }
 
-RING_FUNC(ring_libsql_open_sync_with_webpki)
+RING_FUNC(ring_libsql_get_int)
 {
+	long long value;
 	const char *err_msg;
-	libsql_database_t db;
-	if (RING_API_PARACOUNT != 5)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR("Expected 5 parameters: db_path, primary_url, "
-					   "auth_token, read_your_writes, encryption_key");
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3) || !RING_API_ISNUMBER(4) ||
-		!RING_API_ISSTRING(5))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	int rc = libsql_open_sync_with_webpki(RING_API_GETSTRING(1), RING_API_GETSTRING(2), RING_API_GETSTRING(3),
-										  (char)RING_API_GETNUMBER(4), RING_API_GETSTRING(5), &db, &err_msg);
+	RingLibSQLRow *pRow = ring_libsql_get_row(pPointer, 1);
+	if (!pRow)
+		return;
+	int rc = libsql_get_int(pRow->row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	if (pRow->nInt64Mode != RING_LIBSQL_INT64_NUMBER)
+	{
+		char cValue[21];
+		int nLen = ring_libsql_int64_format(value, pRow->nInt64Mode, cValue);
+		RING_API_RETSTRING2(cValue, nLen);
+		return;
+	}
+	RING_API_RETNUMBER(value);
 }
 
-RING_FUNC(ring_libsql_open_sync_with_config)
+RING_FUNC(ring_libsql_get_float)
 {
-	if (RING_API_PARACOUNT != 1 || !RING_API_ISLIST(1))
+	double value;
+	const char *err_msg;
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR("Expected one parameter: a list representing the config.");
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	List *pList = RING_API_GETLIST(1);
-	libsql_config config = {0};
-	const char *err_msg;
-	libsql_database_t db;
-	for (int i = 1; i <= ring_list_getsize(pList); i++)
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
-		if (!ring_list_islist(pList, i))
-			continue;
-		List *pItem = ring_list_getlist(pList, i);
-		if (ring_list_getsize(pItem) != 2 || !ring_list_isstring(pItem, 1))
-			continue;
-		char *key = ring_string_lower(ring_list_getstring(pItem, 1));
-		if (strcmp(key, "db_path") == 0 && ring_list_isstring(pItem, 2))
-		{
-			config.db_path = ring_list_getstring(pItem, 2);
-		}
-		else if (strcmp(key, "primary_url") == 0 && ring_list_isstring(pItem, 2))
-		{
-			config.primary_url = ring_list_getstring(pItem, 2);
-		}
-		else if (strcmp(key, "auth_token") == 0 && ring_list_isstring(pItem, 2))
-		{
-			config.auth_token = ring_list_getstring(pItem, 2);
-		}
-		else if (strcmp(key, "read_your_writes") == 0 && ring_list_isnumber(pItem, 2))
-		{
-			config.read_your_writes = (char)ring_list_getdouble(pItem, 2);
-		}
-		else if (strcmp(key, "encryption_key") == 0 && ring_list_isstring(pItem, 2))
-		{
-			config.encryption_key = ring_list_getstring(pItem, 2);
-		}
-		else if (strcmp(key, "sync_interval") == 0 && ring_list_isnumber(pItem, 2))
-		{
-			config.sync_interval = (int)ring_list_getdouble(pItem, 2);
-		}
-		else if (strcmp(key, "with_webpki") == 0 && ring_list_isnumber(pItem, 2))
-		{
-			config.with_webpki = (char)ring_list_getdouble(pItem, 2);
-		}
-		else if (strcmp(key, "offline") == 0 && ring_list_isnumber(pItem, 2))
-		{
-			config.offline = (char)ring_list_getdouble(pItem, 2);
-		}
-		else if (strcmp(key, "remote_encryption_key") == 0 && ring_list_isstring(pItem, 2))
-		{
-			config.remote_encryption_key = ring_list_getstring(pItem, 2);
-		}
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
 	}
-	int rc = libsql_open_sync_with_config(config, &db, &err_msg);
+	RingLibSQLRow *pRow = ring_libsql_get_row(pPointer, 1);
+	if (!pRow)
+		return;
+	int rc = libsql_get_float(pRow->row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	RING_API_RETNUMBER(value);
 }
 
-RING_FUNC(ring_libsql_open_ext)
+RING_FUNC(ring_libsql_get_blob)
 {
+	blob b;
 	const char *err_msg;
-	libsql_database_t db;
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(1))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	int rc = libsql_open_ext(RING_API_GETSTRING(1), &db, &err_msg);
+	RingLibSQLRow *pRow = ring_libsql_get_row(pPointer, 1);
+	if (!pRow)
+		return;
+	int rc = libsql_get_blob(pRow->row, (int)RING_API_GETNUMBER(2), &b, &err_msg);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	RING_API_RETSTRING2(b.ptr, b.len);
+	libsql_free_blob(b);
 }
 
-RING_FUNC(ring_libsql_open_file)
+/* Online Backup Functions */
+
+RING_FUNC(ring_libsql_backup_init)
 {
 	const char *err_msg;
-	libsql_database_t db;
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(1))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	int rc = libsql_open_file(RING_API_GETSTRING(1), &db, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	const char *cDest = RING_API_GETSTRING(2);
+	FILE *pFile = fopen(cDest, "rb");
+	if (pFile)
+	{
+		fclose(pFile);
+		RING_API_ERROR("Backup destination already exists");
+		return;
+	}
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)calloc(1, sizeof(RingLibSQLBackup));
+	if (!pBackup || !(pBackup->cDest = ring_libsql_strdup(cDest)))
+	{
+		free(pBackup);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	ring_libsql_mutex_init(&pBackup->mutex);
+	pBackup->nStart = ring_libsql_now_ms();
+	int rc = libsql_connect(pDB->db, &pBackup->conn, &err_msg);
+	if (rc != 0)
+	{
+		pBackup->conn = NULL;
+	}
+	else
+	{
+		rc = ring_libsql_backup_open(pBackup, &err_msg);
+	}
+	if (rc != 0)
+	{
+		char cError[512];
+		snprintf(cError, sizeof(cError), "%s", err_msg ? err_msg : "Backup failed");
+		ring_libsql_free_backup(NULL, pBackup);
+		RING_API_ERROR(cError);
+		return;
+	}
+	RING_API_RETMANAGEDCPOINTER(pBackup, RING_POINTER_LIBSQL_BACKUP, ring_libsql_free_backup);
 }
 
-RING_FUNC(ring_libsql_open_remote)
+RING_FUNC(ring_libsql_backup_step)
 {
-	const char *err_msg;
-	libsql_database_t db;
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	int rc = libsql_open_remote(RING_API_GETSTRING(1), RING_API_GETSTRING(2), &db, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	if (RING_API_GETNUMBER(2) < 1)
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_BACKUP);
+	if (pBackup->lThread)
+	{
+		RING_API_ERROR("Backup is running in the background");
+		return;
+	}
+	if (!pBackup->conn)
+	{
+		RING_API_ERROR("Backup is already finished");
+		return;
+	}
+	int rc = ring_libsql_backup_copy(pBackup, (int)RING_API_GETNUMBER(2));
+	if (rc < 0)
+	{
+		RING_API_ERROR(pBackup->progress.cError);
+		return;
+	}
+	RING_API_RETNUMBER(rc);
 }
 
-RING_FUNC(ring_libsql_open_remote_with_remote_encryption)
+RING_FUNC(ring_libsql_backup_start)
 {
-	const char *err_msg;
-	libsql_database_t db;
 	if (RING_API_PARACOUNT != 3)
 	{
 		RING_API_ERROR(RING_API_MISS3PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	int rc = libsql_open_remote_with_remote_encryption(RING_API_GETSTRING(1), RING_API_GETSTRING(2),
-													   RING_API_GETSTRING(3), &db, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
-}
-
-RING_FUNC(ring_libsql_open_remote_with_webpki)
-{
-	const char *err_msg;
-	libsql_database_t db;
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_GETNUMBER(2) < 1 || RING_API_GETNUMBER(3) < 0)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_BADPARAVALUE);
 		return;
 	}
-	if (!RING_API_ISSTRING(1) || !RING_API_ISSTRING(2))
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_BACKUP);
+	if (pBackup->lThread || !pBackup->conn)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("Backup is already running or finished");
 		return;
 	}
-	int rc = libsql_open_remote_with_webpki(RING_API_GETSTRING(1), RING_API_GETSTRING(2), &db, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(db, RING_POINTER_LIBSQL_DB, ring_libsql_free_db);
+	pBackup->nThreadRows = (int)RING_API_GETNUMBER(2);
+	pBackup->nThreadPause = (int)RING_API_GETNUMBER(3);
+	if (!ring_libsql_thread_start(&pBackup->thread, ring_libsql_backup_thread, pBackup))
+	{
+		RING_API_ERROR("Failed to start the backup thread");
+		return;
+	}
+	pBackup->lThread = 1;
 }
 
-RING_FUNC(ring_libsql_close)
+RING_FUNC(ring_libsql_backup_wait)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
 		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (RING_API_ISPOINTER(1))
+	if (!RING_API_ISPOINTER(1))
 	{
-		libsql_database_t db = (libsql_database_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_DB);
-		if (db)
-		{
-			libsql_close(db);
-			RING_API_SETNULLPOINTER(1);
-		}
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
 	}
-	else
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_BACKUP);
+	if (pBackup->lThread)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		ring_libsql_thread_join(pBackup->thread);
+		pBackup->lThread = 0;
+	}
+	if (pBackup->progress.nState == RING_LIBSQL_BACKUP_FAILED)
+	{
+		RING_API_ERROR(pBackup->progress.cError);
 	}
 }
 
-RING_FUNC(ring_libsql_connect)
+RING_FUNC(ring_libsql_backup_progress)
 {
-	const char *err_msg;
-	libsql_connection_t conn;
+	static const char *aStates[] = {"running", "done", "failed", "cancelled"};
+	RingLibSQLBackupProgress progress;
 	if (RING_API_PARACOUNT != 1)
 	{
 		RING_API_ERROR(RING_API_MISS1PARA);
@@ -358,71 +6150,87 @@ RING_FUNC(ring_libsql_connect)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_database_t db = (libsql_database_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_DB);
-	int rc = libsql_connect(db, &conn, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(conn, RING_POINTER_LIBSQL_CONN, ring_libsql_free_conn);
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_BACKUP);
+	ring_libsql_mutex_lock(&pBackup->mutex);
+	progress = pBackup->progress;
+	ring_libsql_mutex_unlock(&pBackup->mutex);
+	List *pList = RING_API_NEWLIST;
+	List *pItem = ring_list_newlist(pList);
+	ring_list_addstring(pItem, "state");
+	ring_list_addstring(pItem, aStates[progress.nState]);
+	ring_libsql_list_addpair(pList, "tasks_done", progress.nTasksDone);
+	ring_libsql_list_addpair(pList, "tasks_total", progress.nTasksTotal);
+	ring_libsql_list_addpair(pList, "rows_copied", progress.nRowsCopied);
+	ring_libsql_list_addpair(pList, "pages_copied", progress.nPagesCopied);
+	ring_libsql_list_addpair(pList, "pages_total", progress.nPagesTotal);
+	ring_libsql_list_addpair(pList, "restarts", progress.nRestarts);
+	ring_libsql_list_addpair(pList, "elapsed_ms", progress.nElapsedMs);
+	pItem = ring_list_newlist(pList);
+	ring_list_addstring(pItem, "error");
+	ring_list_addstring(pItem, progress.cError);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_libsql_load_extension)
+RING_FUNC(ring_libsql_backup_finish)
 {
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 3)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3))
+	if (!RING_API_ISPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_load_extension(conn, RING_API_GETSTRING(2), RING_API_GETSTRING(3), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	RingLibSQLBackup *pBackup = (RingLibSQLBackup *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_BACKUP);
+	ring_libsql_backup_close(pBackup);
+	if (pBackup->progress.nState == RING_LIBSQL_BACKUP_FAILED)
+	{
+		RING_API_ERROR(pBackup->progress.cError);
+		return;
+	}
+	RING_API_RETNUMBER(pBackup->progress.nState == RING_LIBSQL_BACKUP_DONE);
 }
 
-RING_FUNC(ring_libsql_set_reserved_bytes)
+/* Maintenance Functions */
+
+RING_FUNC(ring_libsql_maintenance_start)
 {
+	RingLibSQLMaintConfig config;
 	const char *err_msg;
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISLIST(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_set_reserved_bytes(conn, (int32_t)RING_API_GETNUMBER(2), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-}
-
-RING_FUNC(ring_libsql_get_reserved_bytes)
-{
-	const char *err_msg;
-	int32_t reserved_bytes;
-	if (RING_API_PARACOUNT != 1)
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	if (pDB->pMaint)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR("Maintenance is already running on this database");
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	if (!ring_libsql_maint_from_list(&config, RING_API_GETLIST(2), &err_msg))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR(err_msg);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_get_reserved_bytes(conn, &reserved_bytes, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETNUMBER(reserved_bytes);
+	pDB->pMaint = ring_libsql_maint_start(pDB->db, &pDB->profile, &config, &err_msg);
+	if (!pDB->pMaint)
+	{
+		RING_API_ERROR(err_msg);
+	}
 }
 
-RING_FUNC(ring_libsql_reset)
+RING_FUNC(ring_libsql_maintenance_stop)
 {
-	const char *err_msg;
 	if (RING_API_PARACOUNT != 1)
 	{
 		RING_API_ERROR(RING_API_MISS1PARA);
@@ -433,92 +6241,137 @@ RING_FUNC(ring_libsql_reset)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_reset(conn, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	if (pDB->pMaint)
+	{
+		ring_libsql_maint_stop(pDB->pMaint);
+		pDB->pMaint = NULL;
+	}
 }
 
-RING_FUNC(ring_libsql_disconnect)
+RING_FUNC(ring_libsql_maintenance_stats)
 {
+	RingLibSQLMaintStats stats;
 	if (RING_API_PARACOUNT != 1)
 	{
 		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (RING_API_ISPOINTER(1))
+	if (!RING_API_ISPOINTER(1))
 	{
-		libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-		if (conn)
-		{
-			libsql_disconnect(conn);
-			RING_API_SETNULLPOINTER(1);
-		}
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
 	}
-	else
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	memset(&stats, 0, sizeof(stats));
+	if (pDB->pMaint)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		ring_libsql_mutex_lock(&pDB->pMaint->mutex);
+		stats = pDB->pMaint->stats;
+		ring_libsql_mutex_unlock(&pDB->pMaint->mutex);
 	}
+	List *pList = RING_API_NEWLIST;
+	ring_libsql_list_addpair(pList, "running", pDB->pMaint != NULL);
+	ring_libsql_list_addpair(pList, "ticks", stats.nTicks);
+	ring_libsql_list_addpair(pList, "wal_bytes", stats.nWalBytes);
+	ring_libsql_list_addpair(pList, "wal_pending_frames", stats.nWalPendingFrames);
+	ring_libsql_list_addpair(pList, "checkpoints", stats.nCheckpoints);
+	ring_libsql_list_addpair(pList, "checkpoints_busy", stats.nCheckpointsBusy);
+	ring_libsql_list_addpair(pList, "checkpoint_frames", stats.nCheckpointFrames);
+	ring_libsql_list_addpair(pList, "checkpoint_last_ms", stats.nCheckpointLastMs);
+	ring_libsql_list_addpair(pList, "checkpoint_max_ms", stats.nCheckpointMaxMs);
+	ring_libsql_list_addpair(pList, "checkpoint_total_ms", stats.nCheckpointTotalMs);
+	ring_libsql_list_addpair(pList, "vacuum_runs", stats.nVacuumRuns);
+	ring_libsql_list_addpair(pList, "pages_freed", stats.nPagesFreed);
+	ring_libsql_list_addpair(pList, "freelist_pages", stats.nFreelistPages);
+	ring_libsql_list_addpair(pList, "idle_ms", stats.nIdleMs);
+	List *pItem = ring_list_newlist(pList);
+	ring_list_addstring(pItem, "error");
+	ring_list_addstring(pItem, stats.cError);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_libsql_prepare)
+/* Replica Sync Functions */
+
+/* Starts a background catch-up: passes repeat until frame_no reaches targetFrame (0 = one pass) or no new
+   pass may start after deadlineMs (0 = no limit). A pass in flight is never cut short. Returns a sync handle */
+RING_FUNC(ring_libsql_sync_start)
 {
 	const char *err_msg;
-	libsql_stmt_t stmt;
-	if (RING_API_PARACOUNT != 2)
+	libsql_connection_t conn;
+	long long nPageSize = 0;
+	int lNull = 1;
+	if (RING_API_PARACOUNT != 3)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS3PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_prepare(conn, RING_API_GETSTRING(2), &stmt, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(stmt, RING_POINTER_LIBSQL_STMT, ring_libsql_free_stmt);
-}
-
-RING_FUNC(ring_libsql_bind_int)
-{
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 3)
+	if (RING_API_GETNUMBER(2) < 0 || RING_API_GETNUMBER(3) < 0)
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	/* A primary that never reaches the target would keep the worker polling forever */
+	if (RING_API_GETNUMBER(2) > 0 && RING_API_GETNUMBER(3) == 0)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR("A target frame needs a pass deadline (deadlineMs > 0)");
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	RingLibSQLDB *pDB = ring_libsql_get_db(pPointer, 1);
+	if (!pDB)
+		return;
+	if (pDB->pSync && ring_libsql_sync_state(pDB->pSync) == RING_LIBSQL_SYNC_RUNNING)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("A sync is already running on this database");
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_bind_int(stmt, (int)RING_API_GETNUMBER(2), (long long)RING_API_GETNUMBER(3), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-}
-
-RING_FUNC(ring_libsql_bind_float)
-{
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 3)
+	/* Frames carry one page each, the page size turns frame counts into bytes */
+	if (libsql_connect(pDB->db, &conn, &err_msg) == 0)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		ring_libsql_query_int(conn, "PRAGMA page_size", &nPageSize, &lNull, &err_msg);
+		libsql_disconnect(conn);
+	}
+	RingLibSQLSync *pSync = (RingLibSQLSync *)calloc(1, sizeof(RingLibSQLSync));
+	if (!pSync)
+	{
+		RING_API_ERROR("Out of memory");
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	pSync->db = pDB->db;
+	pSync->nTargetFrame = RING_API_GETNUMBER(2);
+	pSync->nDeadlineMs = RING_API_GETNUMBER(3);
+	pSync->nPageBytes = (lNull || nPageSize <= 0) ? 4096 : (double)nPageSize;
+	pSync->nStart = ring_libsql_now_ms();
+	ring_libsql_mutex_init(&pSync->mutex);
+	if (!ring_libsql_thread_start(&pSync->thread, ring_libsql_sync_thread, pSync))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		ring_libsql_mutex_destroy(&pSync->mutex);
+		free(pSync);
+		RING_API_ERROR("Failed to start the sync thread");
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_bind_float(stmt, (int)RING_API_GETNUMBER(2), RING_API_GETNUMBER(3), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	pSync->lThread = 1;
+	if (pDB->pSync)
+	{
+		pDB->pSync->pDB = NULL;
+	}
+	pSync->pDB = pDB;
+	pDB->pSync = pSync;
+	RING_API_RETMANAGEDCPOINTER(pSync, RING_POINTER_LIBSQL_SYNC, ring_libsql_free_sync);
 }
 
-RING_FUNC(ring_libsql_bind_null)
+/* Waits up to timeoutMs (negative = until finished), returns 1 once the sync has finished */
+RING_FUNC(ring_libsql_sync_wait)
 {
-	const char *err_msg;
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
@@ -529,52 +6382,73 @@ RING_FUNC(ring_libsql_bind_null)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_bind_null(stmt, (int)RING_API_GETNUMBER(2), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-}
-
-RING_FUNC(ring_libsql_bind_string)
-{
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 3)
+	RingLibSQLSync *pSync = (RingLibSQLSync *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_SYNC);
+	double nTimeout = RING_API_GETNUMBER(2);
+	double nDeadline = ring_libsql_now_ms() + nTimeout;
+	while (pSync->lThread && nTimeout >= 0 && ring_libsql_sync_state(pSync) == RING_LIBSQL_SYNC_RUNNING)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
-		return;
+		double nLeft = nDeadline - ring_libsql_now_ms();
+		if (nLeft <= 0)
+		{
+			RING_API_RETNUMBER(0);
+			return;
+		}
+		ring_libsql_sleep_ms(nLeft < 5 ? (int)nLeft + 1 : 5);
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	if (pSync->lThread)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		ring_libsql_thread_join(pSync->thread);
+		pSync->lThread = 0;
+	}
+	if (pSync->progress.nState == RING_LIBSQL_SYNC_FAILED)
+	{
+		RING_API_ERROR(pSync->progress.cError);
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_bind_string(stmt, (int)RING_API_GETNUMBER(2), RING_API_GETSTRING(3), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	RING_API_RETNUMBER(1);
 }
 
-RING_FUNC(ring_libsql_bind_blob)
+RING_FUNC(ring_libsql_sync_progress)
 {
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 3)
+	static const char *aStates[] = {"running", "done", "failed", "cancelled", "deadline"};
+	RingLibSQLSyncProgress progress;
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	if (!RING_API_ISPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_bind_blob(stmt, (int)RING_API_GETNUMBER(2), (const unsigned char *)RING_API_GETSTRING(3),
-							  RING_API_GETSTRINGSIZE(3), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	RingLibSQLSync *pSync = (RingLibSQLSync *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_SYNC);
+	ring_libsql_mutex_lock(&pSync->mutex);
+	progress = pSync->progress;
+	ring_libsql_mutex_unlock(&pSync->mutex);
+	if (progress.nState == RING_LIBSQL_SYNC_RUNNING)
+	{
+		progress.nElapsedMs = ring_libsql_now_ms() - pSync->nStart;
+	}
+	List *pList = RING_API_NEWLIST;
+	List *pItem = ring_list_newlist(pList);
+	ring_list_addstring(pItem, "state");
+	ring_list_addstring(pItem, aStates[progress.nState]);
+	ring_libsql_list_addpair(pList, "passes", progress.nPasses);
+	ring_libsql_list_addpair(pList, "frame_no", progress.nFrameNo);
+	ring_libsql_list_addpair(pList, "target_frame", pSync->nTargetFrame);
+	ring_libsql_list_addpair(pList, "frames_synced", progress.nFramesSynced);
+	ring_libsql_list_addpair(pList, "bytes", progress.nBytes);
+	ring_libsql_list_addpair(pList, "elapsed_ms", progress.nElapsedMs);
+	ring_libsql_list_addpair(pList, "last_pass_ms", progress.nLastPassMs);
+	pItem = ring_list_newlist(pList);
+	ring_list_addstring(pItem, "error");
+	ring_list_addstring(pItem, progress.cError);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_libsql_query_stmt)
+RING_FUNC(ring_libsql_sync_cancel)
 {
-	const char *err_msg;
-	libsql_rows_t rows;
 	if (RING_API_PARACOUNT != 1)
 	{
 		RING_API_ERROR(RING_API_MISS1PARA);
@@ -585,49 +6459,72 @@ RING_FUNC(ring_libsql_query_stmt)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_query_stmt(stmt, &rows, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(rows, RING_POINTER_LIBSQL_ROWS, ring_libsql_free_rows);
+	RingLibSQLSync *pSync = (RingLibSQLSync *)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_SYNC);
+	/* Only flags the worker: joining here would block until the pass in flight ends, wait() or GC joins it */
+	ring_libsql_mutex_lock(&pSync->mutex);
+	pSync->lCancel = 1;
+	ring_libsql_mutex_unlock(&pSync->mutex);
 }
 
-RING_FUNC(ring_libsql_execute_stmt)
+/* Change Feed Functions */
+
+RING_FUNC(ring_libsql_change_feed_start)
 {
 	const char *err_msg;
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_execute_stmt(stmt, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-}
-
-RING_FUNC(ring_libsql_reset_stmt)
-{
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_GETNUMBER(2) < 1 || RING_API_GETNUMBER(2) > 16777216)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_BADPARAVALUE);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	if (pConn->pFeed)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("The change feed is already started on this connection");
 		return;
 	}
-	libsql_stmt_t stmt = (libsql_stmt_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_STMT);
-	int rc = libsql_reset_stmt(stmt, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
+	unsigned int nCapacity = RING_LIBSQL_CHANGES_MIN_CAPACITY;
+	while (nCapacity < (unsigned int)RING_API_GETNUMBER(2))
+	{
+		nCapacity <<= 1;
+	}
+	RingLibSQLChangeFeed *pFeed = (RingLibSQLChangeFeed *)calloc(1, sizeof(RingLibSQLChangeFeed));
+	if (pFeed)
+	{
+		pFeed->aChanges = (RingLibSQLChange *)malloc(nCapacity * sizeof(RingLibSQLChange));
+	}
+	if (!pFeed || !pFeed->aChanges)
+	{
+		free(pFeed);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	pFeed->nMask = nCapacity - 1;
+	int rc = libsql_execute(pConn->conn,
+							"CREATE TEMP TABLE IF NOT EXISTS ring_libsql_changes "
+							"(seq INTEGER PRIMARY KEY, op INTEGER NOT NULL, tbl INTEGER NOT NULL, rid INTEGER NOT NULL)",
+							&err_msg);
+	if (rc != 0)
+	{
+		ring_libsql_changes_free(pFeed);
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	pConn->pFeed = pFeed;
 }
 
-RING_FUNC(ring_libsql_query)
+RING_FUNC(ring_libsql_change_feed_watch)
 {
 	const char *err_msg;
 	libsql_rows_t rows;
@@ -641,13 +6538,62 @@ RING_FUNC(ring_libsql_query)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_query(conn, RING_API_GETSTRING(2), &rows, &err_msg);
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLChangeFeed *pFeed = pConn->pFeed;
+	const char *cTable = RING_API_GETSTRING(2);
+	if (!pFeed)
+	{
+		RING_API_ERROR("The change feed is not started on this connection");
+		return;
+	}
+	int nTable = ring_libsql_changes_find(pFeed, cTable);
+	if (nTable >= 0 && pFeed->aWatched[nTable])
+	{
+		return;
+	}
+	/* Fails for missing and WITHOUT ROWID tables, which the triggers could not report */
+	char *cQuoted = ring_libsql_quote(cTable, '"');
+	char *cSQL = cQuoted ? ring_libsql_sprintf("SELECT rowid FROM main.%s LIMIT 0", cQuoted) : NULL;
+	free(cQuoted);
+	if (!cSQL)
+	{
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	int rc = libsql_query(pConn->conn, cSQL, &rows, &err_msg);
+	free(cSQL);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETMANAGEDCPOINTER(rows, RING_POINTER_LIBSQL_ROWS, ring_libsql_free_rows);
+	libsql_free_rows(rows);
+	if (nTable < 0)
+	{
+		if (pFeed->nTables == RING_LIBSQL_CHANGES_MAX_TABLES)
+		{
+			RING_API_ERROR("Too many tables in the change feed");
+			return;
+		}
+		/* Table slots are never reused, so a drained change always resolves to its table name */
+		pFeed->aTables[pFeed->nTables] = ring_libsql_strdup(cTable);
+		if (!pFeed->aTables[pFeed->nTables])
+		{
+			RING_API_ERROR("Out of memory");
+			return;
+		}
+		nTable = pFeed->nTables++;
+	}
+	rc = ring_libsql_changes_triggers(pConn, nTable, 1, &err_msg);
+	if (rc != 0)
+	{
+		ring_libsql_changes_triggers(pConn, nTable, 0, &err_msg);
+		RING_API_ERROR(err_msg);
+		return;
+	}
+	pFeed->aWatched[nTable] = 1;
+	pFeed->nWatched++;
 }
 
-RING_FUNC(ring_libsql_execute)
+RING_FUNC(ring_libsql_change_feed_unwatch)
 {
 	const char *err_msg;
 	if (RING_API_PARACOUNT != 2)
@@ -660,29 +6606,27 @@ RING_FUNC(ring_libsql_execute)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	int rc = libsql_execute(conn, RING_API_GETSTRING(2), &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-}
-
-RING_FUNC(ring_libsql_wait_result)
-{
-	if (RING_API_PARACOUNT != 1)
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	if (!pConn->pFeed)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	int nTable = ring_libsql_changes_find(pConn->pFeed, RING_API_GETSTRING(2));
+	if (nTable < 0 || !pConn->pFeed->aWatched[nTable])
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_rows_future_t future = (libsql_rows_future_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROWS_FUTURE);
-	libsql_wait_result(future);
+	int rc = ring_libsql_changes_triggers(pConn, nTable, 0, &err_msg);
+	LIBSQL_CHECK_OK(rc, err_msg);
+	pConn->pFeed->aWatched[nTable] = 0;
+	pConn->pFeed->nWatched--;
 }
 
-RING_FUNC(ring_libsql_column_count)
+RING_FUNC(ring_libsql_change_feed_stop)
 {
+	const char *err_msg;
 	if (RING_API_PARACOUNT != 1)
 	{
 		RING_API_ERROR(RING_API_MISS1PARA);
@@ -693,131 +6637,142 @@ RING_FUNC(ring_libsql_column_count)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_rows_t rows = (libsql_rows_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROWS);
-	RING_API_RETNUMBER(libsql_column_count(rows));
-}
-
-RING_FUNC(ring_libsql_column_name)
-{
-	const char *name;
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 2)
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLChangeFeed *pFeed = pConn->pFeed;
+	if (!pFeed)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	for (int x = 0; x < pFeed->nTables; x++)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
-		return;
+		if (pFeed->aWatched[x])
+		{
+			int rc = ring_libsql_changes_triggers(pConn, x, 0, &err_msg);
+			LIBSQL_CHECK_OK(rc, err_msg);
+			pFeed->aWatched[x] = 0;
+			pFeed->nWatched--;
+		}
 	}
-	libsql_rows_t rows = (libsql_rows_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROWS);
-	int rc = libsql_column_name(rows, (int)RING_API_GETNUMBER(2), &name, &err_msg);
+	int rc = libsql_execute(pConn->conn, "DROP TABLE IF EXISTS temp.ring_libsql_changes", &err_msg);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETSTRING(name);
+	pConn->pFeed = NULL;
+	ring_libsql_changes_free(pFeed);
 }
 
-RING_FUNC(ring_libsql_column_type)
+RING_FUNC(ring_libsql_change_feed_set_int64_mode)
 {
-	int type;
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 3)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISPOINTER(2) || !RING_API_ISNUMBER(3))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_rows_t rows = (libsql_rows_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROWS);
-	libsql_row_t row = (libsql_row_t)RING_API_GETCPOINTER(2, RING_POINTER_LIBSQL_ROW);
-	int rc = libsql_column_type(rows, row, (int)RING_API_GETNUMBER(3), &type, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETNUMBER(type);
-}
-
-RING_FUNC(ring_libsql_changes)
-{
-	if (RING_API_PARACOUNT != 1)
+	int nMode = (int)RING_API_GETNUMBER(2);
+	if (nMode != RING_LIBSQL_INT64_NUMBER && nMode != RING_LIBSQL_INT64_DECIMAL && nMode != RING_LIBSQL_INT64_PACKED)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_BADPARAVALUE);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	if (!pConn->pFeed)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("The change feed is not started on this connection");
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	RING_API_RETNUMBER(libsql_changes(conn));
+	pConn->pFeed->nInt64Mode = nMode;
 }
 
-RING_FUNC(ring_libsql_last_insert_rowid)
+/* Consumer side: returns up to max changes as [op, table, rowid] lists, oldest first; the rowid follows the
+   feed's int64 mode */
+RING_FUNC(ring_libsql_drain_changes)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_connection_t conn = (libsql_connection_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_CONN);
-	RING_API_RETNUMBER(libsql_last_insert_rowid(conn));
-}
-
-RING_FUNC(ring_libsql_next_row)
-{
-	const char *err_msg;
-	libsql_row_t row;
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_GETNUMBER(2) < 1)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_BADPARAVALUE);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1))
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLChangeFeed *pFeed = pConn->pFeed;
+	List *pList = RING_API_NEWLIST;
+	if (!pFeed)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETLIST(pList);
 		return;
 	}
-	libsql_rows_t rows = (libsql_rows_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROWS);
-	int rc = libsql_next_row(rows, &row, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	if (row)
+	unsigned int nHead = pFeed->nHead;
+	unsigned int nCount = RING_LIBSQL_LOAD_ACQUIRE(&pFeed->nTail) - nHead;
+	if ((double)nCount > RING_API_GETNUMBER(2))
+	{
+		nCount = (unsigned int)RING_API_GETNUMBER(2);
+	}
+	for (unsigned int x = 0; x < nCount; x++)
 	{
-		RING_API_RETMANAGEDCPOINTER(row, RING_POINTER_LIBSQL_ROW, ring_libsql_free_row);
+		RingLibSQLChange *pChange = &pFeed->aChanges[(nHead + x) & pFeed->nMask];
+		List *pItem = ring_list_newlist(pList);
+		ring_list_adddouble(pItem, pChange->nOp);
+		ring_list_addstring(pItem, pFeed->aTables[pChange->nTable]);
+		if (pFeed->nInt64Mode != RING_LIBSQL_INT64_NUMBER)
+		{
+			char cValue[21];
+			ring_list_addstring2(pItem, cValue, ring_libsql_int64_format(pChange->nRowID, pFeed->nInt64Mode, cValue));
+		}
+		else
+		{
+			ring_list_adddouble(pItem, (double)pChange->nRowID);
+		}
 	}
+	RING_LIBSQL_STORE_RELEASE(&pFeed->nHead, nHead + nCount);
+	pFeed->nDrained += nCount;
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_libsql_get_string)
+/* Query Plan Functions */
+
+/* Returns the plan of sql as [id, parent, detail] rows; parent links the rows into a tree (0 = root) */
+RING_FUNC(ring_libsql_explain)
 {
-	const char *value;
 	const char *err_msg;
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISPOINTER(1) || !RING_API_ISSTRING(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_row_t row = (libsql_row_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROW);
-	int rc = libsql_get_string(row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	List *pList = RING_API_NEWLIST;
+	int rc = ring_libsql_explain_list(pConn->conn, RING_API_GETSTRING(2), pList, &err_msg);
 	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETSTRING(value);
-	libsql_free_string(value);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_libsql_get_int)
+RING_FUNC(ring_libsql_advisor_start)
 {
-	long long value;
-	const char *err_msg;
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
@@ -828,36 +6783,55 @@ RING_FUNC(ring_libsql_get_int)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_row_t row = (libsql_row_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROW);
-	int rc = libsql_get_int(row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETNUMBER(value);
+	if (RING_API_GETNUMBER(2) < 1 || RING_API_GETNUMBER(2) > 10000)
+	{
+		RING_API_ERROR(RING_API_BADPARAVALUE);
+		return;
+	}
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLAdvisor *pAdvisor = (RingLibSQLAdvisor *)calloc(1, sizeof(RingLibSQLAdvisor));
+	if (pAdvisor)
+	{
+		pAdvisor->nTop = (int)RING_API_GETNUMBER(2);
+		pAdvisor->nCapacity = pAdvisor->nTop * RING_LIBSQL_ADVISOR_SLOTS;
+		pAdvisor->aEntries = (RingLibSQLAdvisorEntry *)calloc(pAdvisor->nCapacity, sizeof(RingLibSQLAdvisorEntry));
+	}
+	if (!pAdvisor || !pAdvisor->aEntries)
+	{
+		free(pAdvisor);
+		RING_API_ERROR("Out of memory");
+		return;
+	}
+	/* Starting again clears what was recorded */
+	ring_libsql_advisor_free(pConn->pAdvisor);
+	pConn->pAdvisor = pAdvisor;
 }
 
-RING_FUNC(ring_libsql_get_float)
+RING_FUNC(ring_libsql_advisor_stop)
 {
-	double value;
-	const char *err_msg;
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_row_t row = (libsql_row_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROW);
-	int rc = libsql_get_float(row, (int)RING_API_GETNUMBER(2), &value, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETNUMBER(value);
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	ring_libsql_advisor_free(pConn->pAdvisor);
+	pConn->pAdvisor = NULL;
 }
 
-RING_FUNC(ring_libsql_get_blob)
+/* Returns the most expensive statements first, each with its timings, plan and the full scans of
+   tables holding at least minRows rows */
+RING_FUNC(ring_libsql_advisor_report)
 {
-	blob b;
-	const char *err_msg;
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
@@ -868,11 +6842,54 @@ RING_FUNC(ring_libsql_get_blob)
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	libsql_row_t row = (libsql_row_t)RING_API_GETCPOINTER(1, RING_POINTER_LIBSQL_ROW);
-	int rc = libsql_get_blob(row, (int)RING_API_GETNUMBER(2), &b, &err_msg);
-	LIBSQL_CHECK_OK(rc, err_msg);
-	RING_API_RETSTRING2(b.ptr, b.len);
-	libsql_free_blob(b);
+	RingLibSQLConn *pConn = ring_libsql_get_conn(pPointer, 1);
+	if (!pConn)
+		return;
+	RingLibSQLAdvisor *pAdvisor = pConn->pAdvisor;
+	double nMinRows = RING_API_GETNUMBER(2);
+	List *pList = RING_API_NEWLIST;
+	if (!pAdvisor)
+	{
+		RING_API_RETLIST(pList);
+		return;
+	}
+	qsort(pAdvisor->aEntries, pAdvisor->nEntries, sizeof(RingLibSQLAdvisorEntry), ring_libsql_advisor_compare);
+	for (int x = 0; x < pAdvisor->nEntries && x < pAdvisor->nTop; x++)
+	{
+		RingLibSQLAdvisorEntry *pEntry = &pAdvisor->aEntries[x];
+		List *pStatement = ring_list_newlist(pList);
+		List *pItem = ring_list_newlist(pStatement);
+		ring_list_addstring(pItem, "sql");
+		ring_list_addstring(pItem, pEntry->cSQL);
+		ring_libsql_list_addpair(pStatement, "calls", pEntry->nCalls);
+		ring_libsql_list_addpair(pStatement, "total_ms", pEntry->nTotalMs);
+		ring_libsql_list_addpair(pStatement, "max_ms", pEntry->nMaxMs);
+		pItem = ring_list_newlist(pStatement);
+		ring_list_addstring(pItem, "plan");
+		List *pPlan = ring_list_newlist(pItem);
+		pItem = ring_list_newlist(pStatement);
+		ring_list_addstring(pItem, "scans");
+		List *pScans = ring_list_newlist(pItem);
+		if (!pEntry->lPlan)
+		{
+			ring_libsql_advisor_capture(pConn, pEntry);
+		}
+		if (!pEntry->cPlanError)
+		{
+			ring_libsql_plan_addlist(pPlan, pEntry->aPlan, pEntry->nPlan);
+			int nWords;
+			char **aWords = ring_libsql_sql_words(pEntry->cSQL, &nWords);
+			for (int y = 0; y < pEntry->nPlan; y++)
+			{
+				ring_libsql_advisor_scan(pConn->conn, aWords, nWords, pEntry->aPlan[y].cDetail, nMinRows, pScans);
+			}
+			ring_libsql_sql_words_free(aWords, nWords);
+		}
+		pItem = ring_list_newlist(pStatement);
+		ring_list_addstring(pItem, "error");
+		ring_list_addstring(pItem, pEntry->cPlanError ? pEntry->cPlanError : "");
+	}
+	RING_API_RETLIST(pList);
 }
 
 /* Constants */
@@ -902,6 +6919,36 @@ RING_FUNC(ring_get_libsql_null)
 	RING_API_RETNUMBER(LIBSQL_NULL);
 }
 
+RING_FUNC(ring_get_libsql_int64_number)
+{
+	RING_API_RETNUMBER(RING_LIBSQL_INT64_NUMBER);
+}
+
+RING_FUNC(ring_get_libsql_int64_decimal)
+{
+	RING_API_RETNUMBER(RING_LIBSQL_INT64_DECIMAL);
+}
+
+RING_FUNC(ring_get_libsql_int64_packed)
+{
+	RING_API_RETNUMBER(RING_LIBSQL_INT64_PACKED);
+}
+
+RING_FUNC(ring_get_libsql_change_insert)
+{
+	RING_API_RETNUMBER(RING_LIBSQL_CHANGE_INSERT);
+}
+
+RING_FUNC(ring_get_libsql_change_update)
+{
+	RING_API_RETNUMBER(RING_LIBSQL_CHANGE_UPDATE);
+}
+
+RING_FUNC(ring_get_libsql_change_delete)
+{
+	RING_API_RETNUMBER(RING_LIBSQL_CHANGE_DELETE);
+}
+
 RING_LIBINIT
 {
 	/* Constants */
@@ -910,14 +6957,22 @@ RING_LIBINIT
 	RING_API_REGISTER("get_libsql_text", ring_get_libsql_text);
 	RING_API_REGISTER("get_libsql_blob", ring_get_libsql_blob);
 	RING_API_REGISTER("get_libsql_null", ring_get_libsql_null);
+	RING_API_REGISTER("get_libsql_int64_number", ring_get_libsql_int64_number);
+	RING_API_REGISTER("get_libsql_int64_decimal", ring_get_libsql_int64_decimal);
+	RING_API_REGISTER("get_libsql_int64_packed", ring_get_libsql_int64_packed);
+	RING_API_REGISTER("get_libsql_change_insert", ring_get_libsql_change_insert);
+	RING_API_REGISTER("get_libsql_change_update", ring_get_libsql_change_update);
+	RING_API_REGISTER("get_libsql_change_delete", ring_get_libsql_change_delete);
 
 	/* Functions */
 	RING_API_REGISTER("libsql_enable_internal_tracing", ring_libsql_enable_internal_tracing);
+	RING_API_REGISTER("libsql_now_ms", ring_libsql_clock_ms);
 	RING_API_REGISTER("libsql_sync", ring_libsql_sync);
 	RING_API_REGISTER("libsql_sync2", ring_libsql_sync2);
 	RING_API_REGISTER("libsql_open_sync", ring_libsql_open_sync);
 	RING_API_REGISTER("libsql_open_sync_with_webpki", ring_libsql_open_sync_with_webpki);
 	RING_API_REGISTER("libsql_open_sync_with_config", ring_libsql_open_sync_with_config);
+	RING_API_REGISTER("libsql_open_with_config", ring_libsql_open_with_config);
 	RING_API_REGISTER("libsql_open_ext", ring_libsql_open_ext);
 	RING_API_REGISTER("libsql_open_file", ring_libsql_open_file);
 	RING_API_REGISTER("libsql_open_remote", ring_libsql_open_remote);
@@ -952,4 +7007,54 @@ RING_LIBINIT
 	RING_API_REGISTER("libsql_get_int", ring_libsql_get_int);
 	RING_API_REGISTER("libsql_get_float", ring_libsql_get_float);
 	RING_API_REGISTER("libsql_get_blob", ring_libsql_get_blob);
+	RING_API_REGISTER("libsql_rows_next", ring_libsql_rows_next);
+	RING_API_REGISTER("libsql_rows_get_type", ring_libsql_rows_get_type);
+	RING_API_REGISTER("libsql_rows_get_string", ring_libsql_rows_get_string);
+	RING_API_REGISTER("libsql_rows_get_int", ring_libsql_rows_get_int);
+	RING_API_REGISTER("libsql_rows_get_float", ring_libsql_rows_get_float);
+	RING_API_REGISTER("libsql_rows_get_blob", ring_libsql_rows_get_blob);
+	RING_API_REGISTER("libsql_rows_get_value", ring_libsql_rows_get_value);
+	RING_API_REGISTER("libsql_fetch_all", ring_libsql_fetch_all);
+	RING_API_REGISTER("libsql_fetch_all_assoc", ring_libsql_fetch_all_assoc);
+	RING_API_REGISTER("libsql_rows_to_csv", ring_libsql_rows_to_csv);
+	RING_API_REGISTER("libsql_rows_to_json", ring_libsql_rows_to_json);
+	RING_API_REGISTER("libsql_rows_has_more", ring_libsql_rows_has_more);
+	RING_API_REGISTER("libsql_conn_stats", ring_libsql_conn_stats);
+	RING_API_REGISTER("libsql_stmt_stats", ring_libsql_stmt_stats);
+	RING_API_REGISTER("libsql_set_busy_strategy", ring_libsql_set_busy_strategy);
+	RING_API_REGISTER("libsql_set_memory_limits", ring_libsql_set_memory_limits);
+	RING_API_REGISTER("libsql_bind_int64", ring_libsql_bind_int64);
+	RING_API_REGISTER("libsql_bind_int64_packed", ring_libsql_bind_int64_packed);
+	RING_API_REGISTER("libsql_rows_set_int64_mode", ring_libsql_rows_set_int64_mode);
+	RING_API_REGISTER("libsql_int64_pack", ring_libsql_int64_pack);
+	RING_API_REGISTER("libsql_int64_unpack", ring_libsql_int64_unpack);
+	RING_API_REGISTER("libsql_backup_init", ring_libsql_backup_init);
+	RING_API_REGISTER("libsql_backup_step", ring_libsql_backup_step);
+	RING_API_REGISTER("libsql_backup_start", ring_libsql_backup_start);
+	RING_API_REGISTER("libsql_backup_wait", ring_libsql_backup_wait);
+	RING_API_REGISTER("libsql_backup_progress", ring_libsql_backup_progress);
+	RING_API_REGISTER("libsql_backup_finish", ring_libsql_backup_finish);
+	RING_API_REGISTER("libsql_maintenance_start", ring_libsql_maintenance_start);
+	RING_API_REGISTER("libsql_maintenance_stop", ring_libsql_maintenance_stop);
+	RING_API_REGISTER("libsql_maintenance_stats", ring_libsql_maintenance_stats);
+	RING_API_REGISTER("libsql_bind_vector", ring_libsql_bind_vector);
+	RING_API_REGISTER("libsql_vector_batch", ring_libsql_vector_batch);
+	RING_API_REGISTER("libsql_vector_top_k", ring_libsql_vector_top_k);
+	RING_API_REGISTER("libsql_vector_pack", ring_libsql_vector_pack);
+	RING_API_REGISTER("libsql_vector_unpack", ring_libsql_vector_unpack);
+	RING_API_REGISTER("libsql_int64_unpack_list", ring_libsql_int64_unpack_list);
+	RING_API_REGISTER("libsql_sync_start", ring_libsql_sync_start);
+	RING_API_REGISTER("libsql_sync_wait", ring_libsql_sync_wait);
+	RING_API_REGISTER("libsql_sync_progress", ring_libsql_sync_progress);
+	RING_API_REGISTER("libsql_sync_cancel", ring_libsql_sync_cancel);
+	RING_API_REGISTER("libsql_change_feed_start", ring_libsql_change_feed_start);
+	RING_API_REGISTER("libsql_change_feed_watch", ring_libsql_change_feed_watch);
+	RING_API_REGISTER("libsql_change_feed_unwatch", ring_libsql_change_feed_unwatch);
+	RING_API_REGISTER("libsql_change_feed_stop", ring_libsql_change_feed_stop);
+	RING_API_REGISTER("libsql_change_feed_set_int64_mode", ring_libsql_change_feed_set_int64_mode);
+	RING_API_REGISTER("libsql_drain_changes", ring_libsql_drain_changes);
+	RING_API_REGISTER("libsql_explain", ring_libsql_explain);
+	RING_API_REGISTER("libsql_advisor_start", ring_libsql_advisor_start);
+	RING_API_REGISTER("libsql_advisor_stop", ring_libsql_advisor_stop);
+	RING_API_REGISTER("libsql_advisor_report", ring_libsql_advisor_report);
 }
\ No newline at end of file